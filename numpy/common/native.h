@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * The C ABI of the native kernel libraries, libumath_native.so and
+ * librng_native.so, which umath_mem_bench.py and rng.py load with ctypes
+ * as their "native" implementation. A kernel times itself with timer.h,
+ * so the difference to the Python row of the same kernel is interpreter
+ * and dispatch overhead only.
+ */
+
+#ifndef __NATIVE_H
+#define __NATIVE_H
+
+/*
+ * Ticks of reps back-to-back calls of the kernel called name on n
+ * elements of x and y into out, or -1 for an unknown name. The libraries
+ * document their names and what x, y and out hold.
+ */
+double run_kernel(const char *name, const double *x, const double *y,
+                  double *out, long n, long reps);
+
+/* ticks per nanosecond of run_kernel */
+double native_ghz(void);
+
+#endif /* __NATIVE_H */
@@ -0,0 +1,10 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "timer.h"
+
+/* the calibration of timer.h, linked into every C harness */
+struct timer_calibration timer_state = {0.0, 0.0, 1};
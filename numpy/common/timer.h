@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Timer shared by the linalg, umath, random and roofline harnesses, usable
+ * from C and C++. Intervals are read from the TSC with fences around the
+ * reads, so that neither earlier nor later instructions drift into the
+ * timed region, and converted to time with a frequency calibrated against
+ * CLOCK_MONOTONIC_RAW. Every harness reports through the same clock, so
+ * CPE, seconds and GB/s can be compared between them.
+ *
+ * Call timer_calibrate() once before timing. When the TSC is not
+ * invariant (it stops in deep C-states or follows the core frequency),
+ * ticks silently become CLOCK_MONOTONIC_RAW nanoseconds instead.
+ */
+
+#ifndef __TIMER_H
+#define __TIMER_H
+
+#include <cpuid.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <x86intrin.h>
+
+typedef uint64_t timer_ticks;
+
+struct timer_calibration {
+    double ghz;      /* ticks per nanosecond */
+    double overhead; /* ticks of a back-to-back timer_start/timer_stop */
+    int invariant;   /* the ticks come from an invariant TSC */
+};
+
+/*
+ * One calibration per program, whichever translation unit calibrates it.
+ * C++ merges the static of an inline function across translation units;
+ * C programs link timer.c, which defines timer_state.
+ */
+#ifdef __cplusplus
+inline struct timer_calibration *timer_get_state() {
+    static struct timer_calibration state = {0.0, 0.0, 1};
+    return &state;
+}
+#else
+extern struct timer_calibration timer_state;
+
+static inline struct timer_calibration *timer_get_state(void) {
+    return &timer_state;
+}
+#endif
+
+/* CLOCK_MONOTONIC_RAW is not slewed by NTP, unlike CLOCK_MONOTONIC */
+static inline double timer_clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* CPUID.80000007H:EDX[8] */
+static inline int timer_invariant_tsc(void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+        return 0;
+    return (edx >> 8) & 1;
+}
+
+/* read at the beginning of a timed region */
+static inline timer_ticks timer_start(void) {
+    timer_ticks t;
+    if (!timer_get_state()->invariant)
+        return (timer_ticks) timer_clock_ns();
+    _mm_lfence();
+    t = __rdtsc();
+    _mm_lfence();
+    return t;
+}
+
+/* read at the end of a timed region; rdtscp waits for earlier loads */
+static inline timer_ticks timer_stop(void) {
+    unsigned int aux;
+    timer_ticks t;
+    if (!timer_get_state()->invariant)
+        return (timer_ticks) timer_clock_ns();
+    t = __rdtscp(&aux);
+    _mm_lfence();
+    return t;
+}
+
+static inline const struct timer_calibration *timer_calibrate(void) {
+    enum { OVERHEAD_SAMPLES = 1000 };
+    struct timer_calibration *state = timer_get_state();
+    double ns0, ns1, best;
+    timer_ticks c0, c1;
+    int i;
+
+    if (state->ghz > 0.0)
+        return state;
+
+    state->invariant = timer_invariant_tsc();
+    if (state->invariant) {
+        ns0 = timer_clock_ns();
+        c0 = timer_start();
+        do {
+            ns1 = timer_clock_ns();
+        } while (ns1 - ns0 < 50e6);
+        c1 = timer_stop();
+        state->ghz = (c1 - c0) / (timer_clock_ns() - ns0);
+    } else {
+        state->ghz = 1.0;
+    }
+
+    best = 1e300;
+    for (i = 0; i < OVERHEAD_SAMPLES; i++) {
+        c0 = timer_start();
+        c1 = timer_stop();
+        if (c1 - c0 < best)
+            best = c1 - c0;
+    }
+    state->overhead = best;
+    return state;
+}
+
+/* ticks in [t0, t1] net of the timer overhead */
+static inline double timer_elapsed(timer_ticks t0, timer_ticks t1) {
+    double ticks = (double) (t1 - t0) - timer_get_state()->overhead;
+    return ticks > 0.0 ? ticks : 0.0;
+}
+
+static inline double timer_seconds(timer_ticks t0, timer_ticks t1) {
+    return timer_elapsed(t0, t1) / (timer_get_state()->ghz * 1e9);
+}
+
+/* one comment line describing the clock, for the head of the output */
+static inline void timer_print(FILE *out, const char *lead) {
+    const struct timer_calibration *cal = timer_calibrate();
+    fprintf(out, "%s timer: %s %.3f GHz, overhead %.0f ticks\n", lead,
+            cal->invariant ? "invariant tsc" : "CLOCK_MONOTONIC_RAW",
+            cal->ghz, cal->overhead);
+}
+
+#endif /* __TIMER_H */
@@ -9,6 +9,7 @@
 #include <iostream>
 #include <cstdio>
 #include <complex>
+#include <limits>
 
 using namespace std;
 
@@ -41,6 +42,10 @@ class Random {
     }
 };
 
+static inline void set_backend_threads(int n) {
+    mkl_set_num_threads(n);
+}
+
 #else
 
 #include "cblas.h"
@@ -59,6 +64,9 @@ static void *mkl_malloc(int size, int align) {
 static void mkl_free(void *p) {
     free(p);
 }
+
+static inline void set_backend_threads(int n) {
+}
 #endif
 
 class Bench {
@@ -72,6 +80,10 @@ class Bench {
         return mat;
     }
 
+    void fill_random_mat(double *mat, int size) {
+        random.init_mat(mat, size);
+    }
+
     double *make_mat(int mat_size) {
         double *mat = (double *) mkl_malloc(mat_size * sizeof(double), 64);
         assert(mat);
@@ -115,6 +127,31 @@ class Bench {
         printf("]\n");
     }
 
+    void mirror_upper(double *x, int n) {
+        // Copy the upper triangle of row-major x into its lower triangle,
+        // as numpy does after calling ?syrk for A * A.T
+        for (int i = 0; i < n; i++)
+            for (int j = i + 1; j < n; j++)
+                x[j * n + i] = x[i * n + j];
+    }
+
+    // Frobenius norm of a matrix of any layout, with parallel BLAS
+    double norm(const double *x, int size) {
+        return cblas_dnrm2(size, x, 1);
+    }
+
+    // Print resid / (scale * n * eps) and check it against the threshold.
+    // Callers fold the condition of the problem into scale, e.g.
+    // |A| * |A**-1| for an inverse, so that the ratio stays O(1) for a
+    // backward stable result at any n.
+    bool check_ratio(const char *what, double resid, double scale, int n) {
+        static const double threshold = 30.0;
+        double ulp = std::numeric_limits<double>::epsilon();
+        double ratio = scale > 0. ? resid / (scale * n * ulp) : resid;
+        printf(" %s %.3g", what, ratio);
+        return ratio < threshold;
+    }
+
     template<typename T>
     bool mat_equal(const T *a, const T *b, int n, double tol) {
         for (int i = 0; i < n; i++)
@@ -129,6 +166,8 @@ class Bench {
         return mat_equal(a, b, n, 0.00000000000001);
     }
 
+    virtual ~Bench() {};
+
     virtual void make_args(int size) = 0;
     virtual void copy_args() = 0;
     virtual void clean_args() = 0;
@@ -136,4 +175,8 @@ class Bench {
     virtual void print_result() = 0;
     virtual void compute() = 0;
     virtual bool test(bool verbose) {return false;};
+    // untimed residual checks of the result of the last compute()
+    virtual bool validate(bool verbose) {return false;};
+    // extra '#' lines after a sample, given the mean time of compute()
+    virtual void print_stats(double seconds) {};
 };
@@ -101,6 +101,24 @@ bool Cholesky::test(bool verbose) {
     return equal;
 }
 
+bool Cholesky::validate(bool verbose) {
+    // |A - U**T * U| / |A|; dsyrk only filled the upper triangle of A
+    double *a = make_mat(mat_size), *c = make_mat(mat_size);
+    memcpy(a, x_mat, mat_size * sizeof(*a));
+    for (int j = 0; j < n; j++)
+        for (int i = j + 1; i < n; i++)
+            a[j * n + i] = a[i * n + j];
+    memcpy(c, a, mat_size * sizeof(*c));
+    cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, n, n, n, -1.0, r_mat,
+                n, r_mat, n, 1.0, c, n);
+
+    bool ok = check_ratio("|A-U**T*U|", norm(c, mat_size), norm(a, mat_size),
+                          n);
+    mkl_free(a);
+    mkl_free(c);
+    return ok;
+}
+
 void Cholesky::print_args() {
     std::cout << "Cholesky decomposition, A = U* * U, of a "
               << "Hermitian positive-definite matrix A." << std::endl;
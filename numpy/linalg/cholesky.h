@@ -17,6 +17,7 @@ class Cholesky : public Bench {
     void print_result();
     void compute();
     bool test(bool verbose);
+    bool validate(bool verbose);
 
   private:
     double *x_mat, *r_mat;
@@ -70,6 +70,35 @@ bool Det::test(bool verbose) {
     return mat_equal(&result, &result_test, 1);
 }
 
+bool Det::validate(bool verbose) {
+    // The determinant is only as good as the LU factors it is read from:
+    // |P * A - L * U| / |A|, with L and U unpacked from the dgetrf output.
+    double *l = make_mat(mat_size), *u = make_mat(mat_size);
+    double *c = make_mat(mat_size);
+    memset(l, 0, mat_size * sizeof(*l));
+    memset(u, 0, mat_size * sizeof(*u));
+    for (int j = 0; j < n; j++) {
+        for (int i = 0; i <= j; i++)
+            u[j * n + i] = r_mat[j * lda + i];
+        l[j * n + j] = 1.0;
+        for (int i = j + 1; i < n; i++)
+            l[j * n + i] = r_mat[j * lda + i];
+    }
+
+    static const int one = 1;
+    memcpy(c, x_mat, mat_size * sizeof(*c));
+    dlaswp(&n, c, &lda, &one, &mn_min, ipiv, &one);
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, n, n, -1.0, l, n,
+                u, n, 1.0, c, n);
+
+    bool ok = check_ratio("|P*A-L*U|", norm(c, mat_size),
+                          norm(x_mat, mat_size), n);
+    mkl_free(l);
+    mkl_free(u);
+    mkl_free(c);
+    return ok;
+}
+
 void Det::print_args() {
     std::cout << "Determinant of " << n << "x" << n << " matrix A."
               << std::endl;
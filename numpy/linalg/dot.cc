@@ -79,6 +79,29 @@ bool Dot::test(bool verbose) {
     return mat_equal(r_mat, r_mat_test, m * n);
 }
 
+bool Dot::validate(bool verbose) {
+    // Freivalds: A * (B * x) == R * x for a random x, in O(n**2)
+    double *x = make_random_mat(n), *t = make_mat(k);
+    double *y = make_mat(m), *z = make_mat(m);
+    cblas_dgemv(CblasRowMajor, CblasNoTrans, k, n, 1.0, b_mat, n, x, 1, 0.0,
+                t, 1);
+    cblas_dgemv(CblasRowMajor, CblasNoTrans, m, k, 1.0, a_mat, k, t, 1, 0.0,
+                y, 1);
+    cblas_dgemv(CblasRowMajor, CblasNoTrans, m, n, 1.0, r_mat, n, x, 1, 0.0,
+                z, 1);
+    cblas_daxpy(m, -1.0, y, 1, z, 1);
+
+    bool ok = check_ratio("|(A*B-R)*x|", norm(z, m),
+                          norm(a_mat, m * k) * norm(b_mat, k * n) *
+                              norm(x, n),
+                          k);
+    mkl_free(x);
+    mkl_free(t);
+    mkl_free(y);
+    mkl_free(z);
+    return ok;
+}
+
 void Dot::print_args() {
     std::cout << "Matrix multiplication A * B." << std::endl;
     std::cout << "A =" << std::endl;
@@ -14,6 +14,7 @@ class Dot : public Bench {
     void copy_args();
     void clean_args();
     bool test(bool verbose);
+    bool validate(bool verbose);
     void print_args();
     void print_result();
     void compute();
@@ -38,7 +38,7 @@ static const double vr_mat_test[] = {0., 0., 0., 0., 0., 0., 0., 0., 0.};
 
 Eig::Eig() {
     a_mat = r_mat = vl_mat = vr_mat = wr_vec = wi_vec = 0;
-    vr_mat_complex = 0;
+    vr_mat_complex = w_vec_complex = 0;
 }
 
 void Eig::make_args(int size) {
@@ -129,6 +129,33 @@ bool Eig::test(bool verbose) {
                mat_equal(vr_mat_complex, vr_mat_complex_test, mat_size);
 }
 
+bool Eig::validate(bool verbose) {
+    // |A * V - V * W| / (|A| * |V|) on the real dgeev output, where a
+    // complex pair (vr + i*vi, wr + i*wi) occupies two columns and
+    //     A * vr = wr * vr - wi * vi,  A * vi = wi * vr + wr * vi
+    double *c = make_mat(mat_size);
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, n, n, 1.0, a_mat,
+                n, vr_mat, n, 0.0, c, n);
+    for (int j = 0; j < n; j++) {
+        double *vr = &vr_mat[j * n];
+        if (wi_vec[j] == 0.0) {
+            cblas_daxpy(n, -wr_vec[j], vr, 1, &c[j * n], 1);
+            continue;
+        }
+        double *vi = vr + n;
+        cblas_daxpy(n, -wr_vec[j], vr, 1, &c[j * n], 1);
+        cblas_daxpy(n, wi_vec[j], vi, 1, &c[j * n], 1);
+        cblas_daxpy(n, -wi_vec[j], vr, 1, &c[(j + 1) * n], 1);
+        cblas_daxpy(n, -wr_vec[j], vi, 1, &c[(j + 1) * n], 1);
+        j++;
+    }
+
+    bool ok = check_ratio("|A*V-V*W|", norm(c, mat_size),
+                          norm(a_mat, mat_size) * norm(vr_mat, mat_size), n);
+    mkl_free(c);
+    return ok;
+}
+
 void Eig::print_args() {
     std::cout << "Eigenvalues and eigenvectors of " << n << "*" << n
               << " matrix A." << std::endl;
@@ -15,6 +15,7 @@ class Eig : public Bench {
     void copy_args();
     void clean_args();
     bool test(bool verbose);
+    bool validate(bool verbose);
     void print_args();
     void print_result();
     void compute();
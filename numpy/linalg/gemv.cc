@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "gemv.h"
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+static const double a_mat_test[] = {
+    0.470442000675409,  -0.176333746005435, 0.481736547564898,
+    -0.291482508170914, 0.007410393215614,  0.805743972141035,
+    -0.44183986349643,  -0.739195206041762, -0.468344563609981};
+
+static const double x_vec_test[] = {-0.279551412836935, -1.866235595807669,
+                                    0.949267732307811};
+
+static const double r_vec_test[] = {0.654864547667531, 0.832521560633530,
+                                    1.058444982016888};
+
+static const int test_size = 3;
+
+Gemv::Gemv() {
+    a_mat = x_vec = r_vec = 0;
+}
+
+void Gemv::clean_args() {
+    if (a_mat)
+        mkl_free(a_mat);
+    if (x_vec)
+        mkl_free(x_vec);
+    if (r_vec)
+        mkl_free(r_vec);
+}
+
+Gemv::~Gemv() {
+    clean_args();
+}
+
+void Gemv::make_args(int size) {
+    m = n = size;
+
+    a_mat = make_random_mat(m * n);
+    x_vec = make_random_mat(n);
+
+    r_vec = make_mat(m);
+
+    copy_args();
+}
+
+void Gemv::copy_args() {
+    // beta == 0, so r_vec is never read
+}
+
+void Gemv::compute() {
+    double alpha = 1.0;
+    double beta = 0.0;
+
+    // np.dot(A, x) on a C-contiguous A: memory bound, every element of A
+    // is read exactly once
+    cblas_dgemv(CblasRowMajor, CblasNoTrans, m, n, alpha, a_mat, n, x_vec, 1,
+                beta, r_vec, 1);
+}
+
+bool Gemv::test(bool verbose) {
+    clean_args();
+    make_args(test_size);
+    memcpy(a_mat, a_mat_test, m * n * sizeof(*a_mat));
+    memcpy(x_vec, x_vec_test, n * sizeof(*x_vec));
+    copy_args();
+    compute();
+
+    return mat_equal(r_vec, r_vec_test, m);
+}
+
+bool Gemv::validate(bool verbose) {
+    // u**T * (A * x) == (A**T * u)**T * x for a random u
+    double *u = make_random_mat(m), *s = make_mat(n);
+    cblas_dgemv(CblasRowMajor, CblasTrans, m, n, 1.0, a_mat, n, u, 1, 0.0, s,
+                1);
+    double resid = fabs(cblas_ddot(m, u, 1, r_vec, 1) -
+                        cblas_ddot(n, s, 1, x_vec, 1));
+
+    bool ok = check_ratio("|u*(A*x-r)|", resid,
+                          norm(u, m) * norm(a_mat, m * n) * norm(x_vec, n),
+                          n);
+    mkl_free(u);
+    mkl_free(s);
+    return ok;
+}
+
+void Gemv::print_args() {
+    std::cout << "Matrix-vector multiplication A * x." << std::endl;
+    std::cout << "A =" << std::endl;
+    print_mat('r', a_mat, m, n);
+    std::cout << "x =" << std::endl;
+    print_mat('r', x_vec, 1, n);
+}
+
+void Gemv::print_result() {
+    std::cout << "A * x =" << std::endl;
+    print_mat('r', r_vec, 1, m);
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "bench.h"
+
+class Gemv : public Bench {
+  public:
+    Gemv();
+    ~Gemv();
+    void make_args(int size);
+    void copy_args();
+    void clean_args();
+    bool test(bool verbose);
+    bool validate(bool verbose);
+    void print_args();
+    void print_result();
+    void compute();
+
+  private:
+    double *a_mat, *x_vec, *r_vec;
+    int m, n;
+};
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// HDR-style histogram of non-negative integer samples. Values below
+// 2 * SUB_BUCKETS are counted exactly; every power of two above that is
+// split into SUB_BUCKETS linear buckets, so any recorded value is known to
+// within 1 / SUB_BUCKETS (1.6%) at a fixed memory cost of a few thousand
+// counters, however long the tail.
+class LatencyHistogram {
+  public:
+    enum { SUB_BITS = 6, SUB_BUCKETS = 1 << SUB_BITS };
+
+    LatencyHistogram() : counts(bucket_index(UINT64_MAX) + 1, 0) {
+        total = 0;
+        max_value = 0;
+    }
+
+    void record(uint64_t v) {
+        counts[bucket_index(v)]++;
+        total++;
+        if (v > max_value)
+            max_value = v;
+    }
+
+    uint64_t count() const {
+        return total;
+    }
+
+    uint64_t max() const {
+        return max_value;
+    }
+
+    // Smallest bucket upper bound with at least p percent of the samples
+    // at or below it; never more than the largest recorded value.
+    uint64_t percentile(double p) const {
+        uint64_t rank = (uint64_t) (p / 100.0 * total + 0.5);
+        if (rank < 1)
+            rank = 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                uint64_t v = bucket_upper(i);
+                return v < max_value ? v : max_value;
+            }
+        }
+        return max_value;
+    }
+
+  private:
+    static int msb(uint64_t v) {
+        return 63 - __builtin_clzll(v);
+    }
+
+    static size_t bucket_index(uint64_t v) {
+        if (v < 2 * SUB_BUCKETS)
+            return v;
+        int shift = msb(v) - SUB_BITS;
+        return 2 * SUB_BUCKETS + (shift - 1) * SUB_BUCKETS +
+               ((v >> shift) - SUB_BUCKETS);
+    }
+
+    static uint64_t bucket_upper(size_t i) {
+        if (i < 2 * SUB_BUCKETS)
+            return i;
+        size_t shift = (i - 2 * SUB_BUCKETS) / SUB_BUCKETS + 1;
+        uint64_t top = (i - 2 * SUB_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS;
+        return ((top + 1) << shift) - 1;
+    }
+
+    std::vector<uint64_t> counts;
+    uint64_t total, max_value;
+};
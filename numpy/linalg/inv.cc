@@ -107,6 +107,22 @@ cleanup:
     return identity;
 }
 
+bool Inv::validate(bool verbose) {
+    // |A * X - I| / (|A| * |X|), which allows for the condition of A
+    double *c = make_mat(mat_size);
+    memset(c, 0, mat_size * sizeof(*c));
+    for (int i = 0; i < n; i++)
+        c[i * n + i] = 1.0;
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, n, n, 1.0,
+                x_mat_init, n, x_mat, n, -1.0, c, n);
+
+    bool ok = check_ratio("|A*X-I|", norm(c, mat_size),
+                          norm(x_mat_init, mat_size) * norm(x_mat, mat_size),
+                          n);
+    mkl_free(c);
+    return ok;
+}
+
 void Inv::print_args() {
     std::cout << "Inverse of " << n << "*" << n << " matrix A." << std::endl;
     std::cout << "A =" << std::endl;
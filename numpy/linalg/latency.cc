@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "latency.h"
+#include "histogram.h"
+#include "timer.h"
+#include <iostream>
+
+// enough calls to fault in the arguments and wake up the thread pool
+static const long warmup_calls = 1000;
+
+void print_latency_header() {
+    std::cout << "Prefix,Function,Size,Calls,Mean:ns,p50:ns,p99:ns,"
+                 "p99.9:ns,Max:ns"
+              << std::endl;
+}
+
+void run_latency(Bench *bench, const std::string &name,
+                 const std::string &prefix, int size, long calls) {
+    // calibrated by the driver
+    const double ghz = timer_get_state()->ghz;
+
+    bench->make_args(size);
+    for (long i = 0; i < warmup_calls; i++) {
+        bench->copy_args();
+        bench->compute();
+    }
+
+    LatencyHistogram hist;
+    double sum = 0.;
+    for (long i = 0; i < calls; i++) {
+        bench->copy_args();
+        timer_ticks t0 = timer_start();
+        bench->compute();
+        timer_ticks t1 = timer_stop();
+        double ticks = timer_elapsed(t0, t1);
+        hist.record((uint64_t) ticks);
+        sum += ticks;
+    }
+
+    std::cout << prefix << "," << name << "," << size << "," << calls << ","
+              << sum / calls / ghz << "," << hist.percentile(50) / ghz << ","
+              << hist.percentile(99) / ghz << ","
+              << hist.percentile(99.9) / ghz << "," << hist.max() / ghz
+              << std::endl;
+}
@@ -0,0 +1,15 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+#include "bench.h"
+#include <string>
+
+// Latency mode: time `calls` single calls of compute() with serialising
+// TSC reads and report percentiles of the per-call latency.
+void print_latency_header();
+void run_latency(Bench *bench, const std::string &name,
+                 const std::string &prefix, int size, long calls);
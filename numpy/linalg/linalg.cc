@@ -8,18 +8,46 @@
 #include "det.h"
 #include "dot.h"
 #include "eig.h"
+#include "gemv.h"
 #include "inv.h"
+#include "latency.h"
 #include "lu.h"
+#include "multi_dot.h"
+#include "ooc_cholesky.h"
+#include "ooc_gemm.h"
+#include "pipeline.h"
 #include "qr.h"
 #include "svd.h"
+#include "syr2k.h"
+#include "syrk.h"
+#include "tenants.h"
+#include "timer.h"
 
-#include <chrono>
 #include <cstdlib>
+#include <functional>
 #include <getopt.h>
 #include <iostream>
 #include <map>
+#include <unistd.h>
 #include <vector>
 
+template <typename T, typename... Args>
+static std::function<Bench *()> make_factory(Args... args) {
+    return [=]() -> Bench * { return new T(args...); };
+}
+
+// options without a short form
+enum {
+    OPT_OOC_DIR = 256,
+    OPT_OOC_MEMORY,
+    OPT_OOC_TILE,
+    OPT_TENANTS,
+    OPT_THREADS,
+    OPT_PIPELINE,
+    OPT_LATENCY,
+    OPT_VALIDATE
+};
+
 static const struct option longopts[] = {
     {"size", required_argument, nullptr, 'n'},
     {"reps", required_argument, nullptr, 'r'},
@@ -28,25 +56,30 @@ static const struct option longopts[] = {
     {"verbose", no_argument, nullptr, 'v'},
     {"help", no_argument, nullptr, 'h'},
     {"test", no_argument, nullptr, 't'},
+    {"ooc-dir", required_argument, nullptr, OPT_OOC_DIR},
+    {"ooc-memory", required_argument, nullptr, OPT_OOC_MEMORY},
+    {"ooc-tile", required_argument, nullptr, OPT_OOC_TILE},
+    {"tenants", required_argument, nullptr, OPT_TENANTS},
+    {"threads", required_argument, nullptr, OPT_THREADS},
+    {"pipeline", required_argument, nullptr, OPT_PIPELINE},
+    {"latency", required_argument, nullptr, OPT_LATENCY},
+    {"validate", no_argument, nullptr, OPT_VALIDATE},
     {0, 0, 0, 0}};
 
 int main(int argc, char *argv[]) {
 
-    std::map<std::string, Bench *> all_benches = {{"cholesky", new Cholesky()},
-                                                  {"det", new Det()},
-                                                  {"dot", new Dot()},
-                                                  {"eig", new Eig()},
-                                                  {"inv", new Inv()},
-                                                  {"lu", new LU()},
-                                                  {"qr", new QR()},
-                                                  {"svd", new SVD()}};
-
     int n = 1000;
     int reps = 3;
     int samples = 1;
     bool verbose = false;
     bool test = false;
+    bool validate = false;
     std::string prefix = "Native-C";
+    OocConfig ooc_config;
+    int tenants = 0;
+    int threads = 0;
+    int pipeline = 0;
+    int latency_calls = 0;
 
     int intarg;
     int opt;
@@ -57,6 +90,12 @@ int main(int argc, char *argv[]) {
         case 'n':
         case 'r':
         case 's':
+        case OPT_OOC_MEMORY:
+        case OPT_OOC_TILE:
+        case OPT_TENANTS:
+        case OPT_THREADS:
+        case OPT_PIPELINE:
+        case OPT_LATENCY:
             try {
                 intarg = std::stoi(optarg);
             } catch (const std::exception &ex) {
@@ -74,15 +113,26 @@ int main(int argc, char *argv[]) {
         case 'p':
             prefix = optarg;
             break;
+        case OPT_OOC_DIR:
+            ooc_config.dir = optarg;
+            break;
         case 'v':
             verbose = true;
             break;
         case 't':
             test = true;
             break;
+        case OPT_VALIDATE:
+            validate = true;
+            break;
         case 'h':
             std::cout << "usage: " << argv[0] << " [-h] [-t] [-v]";
             std::cout << " [-n SIZE] [-r REPETITIONS] [-s SAMPLES]";
+            std::cout << " [--ooc-dir DIR] [--ooc-memory MIB]";
+            std::cout << " [--ooc-tile TILE]";
+            std::cout << " [--tenants K [--threads T] | --pipeline DEPTH |";
+            std::cout << " --latency CALLS]";
+            std::cout << " [--validate]";
             std::cout << " [BENCHMARKS...]" << std::endl;
             return EXIT_SUCCESS;
         case '?':
@@ -100,9 +150,59 @@ int main(int argc, char *argv[]) {
         case 's':
             samples = intarg;
             break;
+        case OPT_OOC_MEMORY:
+            ooc_config.memory = (size_t) intarg << 20;
+            break;
+        case OPT_OOC_TILE:
+            ooc_config.tile = intarg;
+            break;
+        case OPT_TENANTS:
+            tenants = intarg;
+            break;
+        case OPT_THREADS:
+            threads = intarg;
+            break;
+        case OPT_PIPELINE:
+            if (intarg < 2) {
+                std::cerr << "error: pipeline depth must be at least 2"
+                          << std::endl;
+                return EXIT_FAILURE;
+            }
+            pipeline = intarg;
+            break;
+        case OPT_LATENCY:
+            latency_calls = intarg;
+            break;
         }
     }
 
+    std::map<std::string, std::function<Bench *()> > bench_factories = {
+        {"cholesky", make_factory<Cholesky>()},
+        {"det", make_factory<Det>()},
+        {"dot", make_factory<Dot>()},
+        {"eig", make_factory<Eig>()},
+        {"gemv", make_factory<Gemv>()},
+        {"inv", make_factory<Inv>()},
+        {"lu", make_factory<LU>()},
+        {"multi_dot", make_factory<MultiDot>("docs", true)},
+        {"multi_dot_naive", make_factory<MultiDot>("docs", false)},
+        {"multi_dot_gram", make_factory<MultiDot>("gram", true)},
+        {"multi_dot_gram_naive", make_factory<MultiDot>("gram", false)},
+        {"multi_dot_ltr", make_factory<MultiDot>("ltr", true)},
+        {"multi_dot_ltr_naive", make_factory<MultiDot>("ltr", false)},
+        {"multi_dot_tall", make_factory<MultiDot>("tall", true)},
+        {"multi_dot_tall_naive", make_factory<MultiDot>("tall", false)},
+        {"ooc_cholesky", make_factory<OocCholesky>(ooc_config)},
+        {"ooc_gemm", make_factory<OocGemm>(ooc_config)},
+        {"qr", make_factory<QR>()},
+        {"svd", make_factory<SVD>()},
+        {"syr2k", make_factory<Syr2k>()},
+        {"syrk", make_factory<Syrk>()}};
+
+    std::map<std::string, Bench *> all_benches;
+    for (auto const &factory : bench_factories)
+        all_benches[factory.first] = factory.second();
+
     std::vector<std::string> benches;
     if (optind < argc) {
         for (; optind < argc; optind++)
@@ -114,8 +214,44 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    if (!test)
-        std::cout << "Prefix,Function,Size,Time" << std::endl;
+    // the other modes replace the default timing loop, one at a time
+    if ((tenants > 0) + (pipeline > 0) + (latency_calls > 0) > 1) {
+        std::cerr << "error: --tenants, --pipeline and --latency are mutually "
+                     "exclusive"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (threads > 0 && tenants == 0) {
+        std::cerr << "error: --threads only applies to --tenants" << std::endl;
+        return EXIT_FAILURE;
+    }
+    // and have their own timing loops, which neither repeat samples nor
+    // validate
+    if ((tenants > 0 || pipeline > 0 || latency_calls > 0) &&
+        (validate || samples > 1)) {
+        std::cerr << "error: --validate and --samples only apply to the "
+                     "default mode, not to --tenants, --pipeline or "
+                     "--latency"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (tenants > 0 && threads == 0)
+        threads = max(1, (int) sysconf(_SC_NPROCESSORS_ONLN) / tenants);
+
+    if (!test) {
+        timer_calibrate();
+        if (verbose)
+            timer_print(stdout, "#");
+        if (tenants > 0)
+            print_tenants_header();
+        else if (pipeline > 0)
+            print_pipeline_header();
+        else if (latency_calls > 0)
+            print_latency_header();
+        else
+            std::cout << "Prefix,Function,Size,Time" << std::endl;
+    }
 
     int return_value = 0;
 
@@ -126,56 +262,90 @@ int main(int argc, char *argv[]) {
             continue;
         }
 
-        Bench *real_bench = all_benches[bench];
+        try {
+            Bench *real_bench = all_benches[bench];
 
-        if (test) {
-            if (verbose)
-                std::cout << "---" << std::endl;
+            if (test) {
+                if (verbose)
+                    std::cout << "---" << std::endl;
+
+                if (!real_bench->test(verbose)) {
+                    std::cout << "FAIL: " << bench;
+                    return_value = 1;
+                } else {
+                    std::cout << "pass: " << bench;
+                }
+                std::cout << std::endl;
 
-            if (!real_bench->test(verbose)) {
-                std::cout << "FAIL: " << bench;
-                return_value = 1;
-            } else {
-                std::cout << "pass: " << bench;
+                if (verbose) {
+                    real_bench->print_args();
+                    real_bench->print_result();
+                }
+                continue;
+            }
+            if (tenants > 0) {
+                if (!run_tenants(real_bench, bench, prefix, n, reps, tenants,
+                                 threads))
+                    return_value = 1;
+                continue;
+            }
+            if (pipeline > 0) {
+                run_pipeline(bench_factories[bench], bench, prefix, n, reps,
+                             pipeline);
+                continue;
+            }
+            if (latency_calls > 0) {
+                run_latency(real_bench, bench, prefix, n, latency_calls);
+                continue;
             }
-            std::cout << std::endl;
 
-            if (verbose) {
+            real_bench->make_args(n);
+
+            if (verbose)
                 real_bench->print_args();
-                real_bench->print_result();
-            }
-            continue;
-        }
-        real_bench->make_args(n);
 
-        if (verbose)
-            real_bench->print_args();
+            // warm up
+            real_bench->copy_args();
+            real_bench->compute();
+
+            for (int i = 0; i < samples; i++) {
 
-        // warm up
-        real_bench->copy_args();
-        real_bench->compute();
+                double timedelta = 0.0;
 
-        for (int i = 0; i < samples; i++) {
+                for (int j = 0; j < reps; j++) {
+                    real_bench->copy_args();
+                    timer_ticks t0 = timer_start();
+                    real_bench->compute();
+                    timer_ticks t1 = timer_stop();
+                    timedelta += timer_seconds(t0, t1);
+                }
 
-            std::chrono::duration<double> timedelta(0.0);
+                std::cout << prefix << ",";
+                std::cout << bench << ",";
+                std::cout << n << ",";
+                std::cout << timedelta / reps;
+                std::cout << std::endl;
 
-            for (int j = 0; j < reps; j++) {
-                real_bench->copy_args();
-                auto t0 = std::chrono::system_clock::now();
-                real_bench->compute();
-                auto t1 = std::chrono::system_clock::now();
-                timedelta += t1 - t0;
+                real_bench->print_stats(timedelta / reps);
             }
 
-            std::cout << prefix << ",";
-            std::cout << bench << ",";
-            std::cout << n << ",";
-            std::cout << (double) timedelta.count() / reps;
-            std::cout << std::endl;
-        }
+            // residuals of the last timed result, outside of the timing
+            if (validate) {
+                std::cout << "# validate " << bench << ":" << std::flush;
+                bool ok = real_bench->validate(verbose);
+                std::cout << (ok ? " pass" : " FAIL") << std::endl;
+                if (!ok)
+                    return_value = 1;
+            }
 
-        if (verbose)
-            real_bench->print_result();
+            if (verbose)
+                real_bench->print_result();
+        } catch (const std::exception &ex) {
+            // e.g. the out-of-core benches cannot set up their files
+            std::cerr << "error: " << bench << ": " << ex.what()
+                      << std::endl;
+            return_value = 1;
+        }
     }
 
     // Free benches allocated in heap
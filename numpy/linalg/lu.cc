@@ -33,6 +33,7 @@ static const int test_size = 3;
 
 LU::LU() {
     x_mat = r_mat = l_mat = u_mat = p_mat = 0;
+    ipiv = 0;
 }
 
 void LU::make_args(int size) {
@@ -133,6 +134,22 @@ bool LU::test(bool verbose) {
            mat_equal(u_mat, u_mat_test, mat_size);
 }
 
+bool LU::validate(bool verbose) {
+    // |A - P * L * U| / |A|
+    double *t = make_mat(mat_size), *c = make_mat(mat_size);
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, m, n, mn_min, 1.0,
+                l_mat, m, u_mat, mn_min, 0.0, t, m);
+    memcpy(c, x_mat, mat_size * sizeof(*c));
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, m, n, m, -1.0,
+                p_mat, m, t, m, 1.0, c, m);
+
+    bool ok = check_ratio("|A-P*L*U|", norm(c, mat_size),
+                          norm(x_mat, mat_size), n);
+    mkl_free(t);
+    mkl_free(c);
+    return ok;
+}
+
 void LU::print_args() {
     std::cout << "LU decomposition P*L*U of " << m << "*" << n << " matrix A."
               << std::endl;
@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "multi_dot.h"
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+static const double a_mat_test[] = {
+    0.470442000675409,  -0.176333746005435, 0.481736547564898,
+    -0.291482508170914, 0.007410393215614,  0.805743972141035,
+    -0.44183986349643,  -0.739195206041762, -0.468344563609981};
+
+static const double b_mat_test[] = {
+    -0.279551412836935, -1.866235595807669, 0.949267732307811,
+    0.393910888693485,  0.357832357041521,  1.430099195743549,
+    -0.202579028296422, -1.225349132812327, 0.535350173863021};
+
+// A * B * A
+static const double r_mat_test[] = {
+    0.106061764492491, -0.293038116064945, -1.589535054699773,
+    0.018354348535583, -0.111524257468578, -0.470453834285481,
+    0.398410667020095, 1.298030704947629,  1.687574891105337};
+
+static const int test_size = 3;
+
+MultiDot::MultiDot(const std::string &chain, bool optimal)
+    : chain(chain), optimal(optimal) {
+    k = 0;
+}
+
+void MultiDot::clean_args() {
+    for (auto mat : mats)
+        if (mat)
+            mkl_free(mat);
+    for (auto temp : temps)
+        if (temp)
+            mkl_free(temp);
+    mats.clear();
+    temps.clear();
+}
+
+MultiDot::~MultiDot() {
+    clean_args();
+}
+
+void MultiDot::make_chain(const std::vector<int> &shape) {
+    dims = shape;
+    k = dims.size() - 1;
+
+    for (int i = 0; i < k; i++)
+        mats.push_back(make_random_mat(dims[i] * dims[i + 1]));
+
+    cost.assign(k * k, 0.);
+    split.assign(k * k, 0);
+    temps.assign(k * k, (double *) 0);
+
+    chain_order();
+    alloc_temps(0, k - 1);
+}
+
+std::vector<int> MultiDot::chain_dims(const std::string &chain, int size) {
+    auto part = [size](int d) { return max(size / d, 1); };
+
+    // U * V**T * W with rank size / 50 factors, as in a low-rank update;
+    // right to left is 50 times cheaper
+    if (chain == "tall")
+        return {size, part(50), size, part(50)};
+    // X**T * X * X**T * y of a least squares problem with size / 10
+    // features, evaluated right to left as matrix-vector products
+    if (chain == "gram")
+        return {part(10), size, part(10), size, 1};
+    // widening chain where left to right is already the optimal order,
+    // so both variants run the same products
+    if (chain == "ltr")
+        return {part(16), part(8), part(4), part(2), size};
+    // the example in the numpy.linalg.multi_dot docs, A (10000, 100),
+    // B (100, 1000), C (1000, 5), D (5, 333), scaled so that the outer
+    // dimension equals size
+    assert(chain == "docs");
+    return {size, part(10), size, part(200), part(3)};
+}
+
+void MultiDot::make_args(int size) {
+    make_chain(chain_dims(chain, size));
+}
+
+void MultiDot::copy_args() {
+    // beta == 0 in every product, so the temporaries are never read
+}
+
+void MultiDot::chain_order() {
+    // numpy.linalg._multi_dot_matrix_chain_order: O(k^3) dynamic program
+    // for the parenthesisation with the fewest scalar multiplications.
+    for (int i = 0; i < k; i++)
+        cost[i * k + i] = 0.;
+
+    for (int l = 1; l < k; l++) {
+        for (int i = 0; i < k - l; i++) {
+            int j = i + l;
+            if (!optimal) {
+                split[i * k + j] = j - 1;
+                cost[i * k + j] = chain_cost(i, j - 1) +
+                                  (double) dims[i] * dims[j] * dims[j + 1];
+                continue;
+            }
+
+            cost[i * k + j] = std::numeric_limits<double>::infinity();
+            for (int s = i; s < j; s++) {
+                double c = cost[i * k + s] + cost[(s + 1) * k + j] +
+                           (double) dims[i] * dims[s + 1] * dims[j + 1];
+                if (c < cost[i * k + j]) {
+                    cost[i * k + j] = c;
+                    split[i * k + j] = s;
+                }
+            }
+        }
+    }
+}
+
+double MultiDot::chain_cost(int i, int j) {
+    return cost[i * k + j];
+}
+
+void MultiDot::alloc_temps(int i, int j) {
+    if (i == j)
+        return;
+
+    int s = split[i * k + j];
+    temps[i * k + j] = make_mat(dims[i] * dims[j + 1]);
+    alloc_temps(i, s);
+    alloc_temps(s + 1, j);
+}
+
+const double *MultiDot::evaluate(int i, int j) {
+    if (i == j)
+        return mats[i];
+
+    int s = split[i * k + j];
+    const double *l_mat = evaluate(i, s);
+    const double *r_mat = evaluate(s + 1, j);
+    double *out = temps[i * k + j];
+
+    int m = dims[i], n = dims[j + 1], inner = dims[s + 1];
+    cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, m, n, inner, 1.0,
+                l_mat, inner, r_mat, n, 0.0, out, n);
+    return out;
+}
+
+double *MultiDot::result() {
+    return temps[k - 1];
+}
+
+void MultiDot::compute() {
+    // numpy recomputes the order on every call, so do we. It is O(k^3)
+    // for a handful of matrices and does not show up in the timings.
+    if (optimal)
+        chain_order();
+    evaluate(0, k - 1);
+}
+
+bool MultiDot::test(bool verbose) {
+    clean_args();
+    make_chain({test_size, test_size, test_size, test_size});
+    memcpy(mats[0], a_mat_test, test_size * test_size * sizeof(double));
+    memcpy(mats[1], b_mat_test, test_size * test_size * sizeof(double));
+    memcpy(mats[2], a_mat_test, test_size * test_size * sizeof(double));
+    copy_args();
+    compute();
+    bool ok = mat_equal(result(), r_mat_test, test_size * test_size);
+
+    // A (30x10) * (B (10x60) * C (60x5)) takes 3000 + 1500 scalar
+    // multiplications, left to right 18000 + 9000, so the split differs
+    clean_args();
+    make_chain({30, 10, 60, 5});
+    copy_args();
+    compute();
+    ok = ok && split[k - 1] == (optimal ? 0 : 1) &&
+         chain_cost(0, k - 1) == (optimal ? 4500. : 27000.);
+
+    std::vector<double> ab(30 * 60, 0.), abc(30 * 5, 0.);
+    for (int i = 0; i < 30; i++)
+        for (int l = 0; l < 10; l++)
+            for (int j = 0; j < 60; j++)
+                ab[i * 60 + j] += mats[0][i * 10 + l] * mats[1][l * 60 + j];
+    for (int i = 0; i < 30; i++)
+        for (int l = 0; l < 60; l++)
+            for (int j = 0; j < 5; j++)
+                abc[i * 5 + j] += ab[i * 60 + l] * mats[2][l * 5 + j];
+    return ok && mat_equal(result(), abc.data(), 30 * 5, 1e-10);
+}
+
+bool MultiDot::validate(bool verbose) {
+    // Freivalds: A0 * (A1 * (... * x)) == R * x for a random x
+    int inner = 0;
+    for (int d : dims)
+        inner = max(inner, d);
+
+    double *x = make_random_mat(dims[k]);
+    double *y = make_mat(inner), *t = make_mat(inner), *z = make_mat(dims[0]);
+    double scale = norm(x, dims[k]);
+    memcpy(y, x, dims[k] * sizeof(*y));
+    for (int i = k - 1; i >= 0; i--) {
+        cblas_dgemv(CblasRowMajor, CblasNoTrans, dims[i], dims[i + 1], 1.0,
+                    mats[i], dims[i + 1], y, 1, 0.0, t, 1);
+        std::swap(y, t);
+        scale *= norm(mats[i], dims[i] * dims[i + 1]);
+    }
+    cblas_dgemv(CblasRowMajor, CblasNoTrans, dims[0], dims[k], 1.0, result(),
+                dims[k], x, 1, 0.0, z, 1);
+    cblas_daxpy(dims[0], -1.0, y, 1, z, 1);
+
+    // rounding errors of the k - 1 products add up
+    bool ok = check_ratio("|(A0*...*Ak-R)*x|", norm(z, dims[0]), scale,
+                          k * inner);
+    mkl_free(x);
+    mkl_free(y);
+    mkl_free(t);
+    mkl_free(z);
+    return ok;
+}
+
+void MultiDot::print_args() {
+    std::cout << "Matrix chain product of " << k << " matrices (" << chain
+              << " chain) with "
+              << (optimal ? "optimal" : "left-to-right")
+              << " parenthesisation." << std::endl;
+    for (int i = 0; i < k; i++) {
+        std::cout << "A" << i << " (" << dims[i] << "x" << dims[i + 1]
+                  << ") =" << std::endl;
+        print_mat('r', mats[i], dims[i], dims[i + 1]);
+    }
+    std::cout << "Scalar multiplications: " << chain_cost(0, k - 1)
+              << std::endl;
+}
+
+void MultiDot::print_result() {
+    std::cout << "A0 * ... * A" << k - 1 << " =" << std::endl;
+    print_mat('r', result(), dims[0], dims[k]);
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "bench.h"
+#include <string>
+#include <vector>
+
+class MultiDot : public Bench {
+  public:
+    MultiDot(const std::string &chain, bool optimal);
+    ~MultiDot();
+    void make_args(int size);
+    void copy_args();
+    void clean_args();
+    bool test(bool verbose);
+    bool validate(bool verbose);
+    void print_args();
+    void print_result();
+    void compute();
+
+  private:
+    static std::vector<int> chain_dims(const std::string &chain, int size);
+    void make_chain(const std::vector<int> &shape);
+    void chain_order();
+    double chain_cost(int i, int j);
+    const double *evaluate(int i, int j);
+    void alloc_temps(int i, int j);
+    double *result();
+
+    // the shape chain of make_args(), see chain_dims()
+    std::string chain;
+
+    // optimal == false evaluates ((A B) C) D ... left to right
+    bool optimal;
+
+    // matrix i has shape dims[i] x dims[i+1]
+    std::vector<int> dims;
+    std::vector<double *> mats;
+
+    // k x k tables indexed by [i * k + j] for the subchain i..j
+    std::vector<double> cost;
+    std::vector<int> split;
+    std::vector<double *> temps;
+    int k;
+};
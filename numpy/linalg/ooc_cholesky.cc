@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ooc_cholesky.h"
+#include <cstring>
+#include <iostream>
+
+static const int test_size = 5;
+static const int test_tile = 2;
+
+// in memory: the tile being updated, the factored diagonal tile of the
+// current block column, and a double-buffered pair of factor tiles
+static const int resident_tiles = 6;
+
+OocCholesky::OocCholesky(const OocConfig &config) : config(config) {
+    acc = diag = 0;
+    n = tile = 0;
+}
+
+void OocCholesky::clean_args() {
+    if (acc)
+        mkl_free(acc);
+    if (diag)
+        mkl_free(diag);
+    acc = diag = 0;
+    stream.clean_buffers();
+    x_mat.release();
+    r_mat.release();
+}
+
+OocCholesky::~OocCholesky() {
+    clean_args();
+}
+
+void OocCholesky::make_tiles(int size, int tile_order) {
+    n = size;
+    tile = tile_order;
+
+    x_mat.create(config.dir, n, tile);
+    r_mat.create(config.dir, n, tile);
+
+    acc = make_mat(tile * tile);
+    diag = make_mat(tile * tile);
+
+    // Forming X * X**T as the in-memory bench does would itself be an
+    // out-of-core product, so use a symmetric random matrix shifted by
+    // 2n * I instead, which is diagonally dominant and hence positive
+    // definite.
+    int nt = x_mat.tiles();
+    for (int j = 0; j < nt; j++) {
+        for (int i = j; i < nt; i++) {
+            fill_random_mat(acc, tile * tile);
+            if (i == j) {
+                for (int c = 0; c < tile; c++) {
+                    acc[c * tile + c] += 2.0 * n;
+                    for (int r = 0; r < c; r++)
+                        acc[c * tile + r] = acc[r * tile + c];
+                }
+                x_mat.store(i, j, acc);
+                continue;
+            }
+            x_mat.store(i, j, acc);
+            for (int c = 0; c < tile; c++)
+                for (int r = 0; r < tile; r++)
+                    diag[c * tile + r] = acc[r * tile + c];
+            x_mat.store(j, i, diag);
+        }
+    }
+
+    // Left-looking: block column k of L is
+    //     L(i, k) = (A(i, k) - sum_{j < k} L(i, j) * L(k, j)**T) * L(k, k)**-T
+    // so every step streams the tile to update or a pair of factor tiles.
+    schedule.clear();
+    for (int k = 0; k < nt; k++) {
+        for (int i = k; i < nt; i++) {
+            schedule.push_back({{&r_mat, i, k}});
+            for (int j = 0; j < k; j++) {
+                if (i == k)
+                    schedule.push_back({{&r_mat, k, j}});
+                else
+                    schedule.push_back({{&r_mat, i, j}, {&r_mat, k, j}});
+            }
+        }
+    }
+
+    stream.make_buffers(tile, 2);
+    copy_args();
+}
+
+void OocCholesky::make_args(int size) {
+    make_tiles(size, config.choose_tile(size, resident_tiles));
+}
+
+void OocCholesky::copy_args() {
+    // the factorization is in place, start from a fresh copy of A
+    r_mat.copy_from(x_mat);
+}
+
+void OocCholesky::compute() {
+    r_mat.reset_counters();
+
+    int nt = r_mat.tiles();
+    stream.start(&schedule);
+    for (int k = 0; k < nt; k++) {
+        int nk = r_mat.tile_dim(k);
+        for (int i = k; i < nt; i++) {
+            int ni = r_mat.tile_dim(i);
+            memcpy(acc, stream.next()[0], tile * tile * sizeof(*acc));
+
+            for (int j = 0; j < k; j++) {
+                double *const *t = stream.next();
+                if (i == k)
+                    cblas_dsyrk(CblasColMajor, CblasLower, CblasNoTrans, nk,
+                                r_mat.tile_dim(j), -1.0, t[0], tile, 1.0, acc,
+                                tile);
+                else
+                    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, ni,
+                                nk, r_mat.tile_dim(j), -1.0, t[0], tile, t[1],
+                                tile, 1.0, acc, tile);
+            }
+
+            if (i == k) {
+                int info = LAPACKE_dpotrf(LAPACK_COL_MAJOR, 'L', nk, acc, tile);
+                assert(info == 0);
+                // leave only L in the diagonal tile
+                for (int c = 1; c < nk; c++)
+                    memset(&acc[c * tile], 0, c * sizeof(*acc));
+                memcpy(diag, acc, tile * tile * sizeof(*acc));
+            } else {
+                cblas_dtrsm(CblasColMajor, CblasRight, CblasLower, CblasTrans,
+                            CblasNonUnit, ni, nk, 1.0, diag, tile, acc, tile);
+            }
+            r_mat.store(i, k, acc);
+        }
+    }
+    stream.finish();
+}
+
+void OocCholesky::print_stats(double seconds) {
+    double flops = n * (double) n * n / 3.0;
+    double read = r_mat.bytes_read;
+    double written = r_mat.bytes_written;
+
+    printf("# ooc_cholesky: tile %d, %.1f MiB resident, %.3f GFLOP/s, "
+           "read %.3f GB/s, write %.3f GB/s\n",
+           tile, resident_tiles * r_mat.tile_bytes() / 1048576.0,
+           flops / seconds * 1e-9, read / seconds * 1e-9,
+           written / seconds * 1e-9);
+}
+
+bool OocCholesky::test(bool verbose) {
+    clean_args();
+    make_tiles(test_size, test_tile);
+    copy_args();
+    compute();
+
+    // try to reconstruct A from the lower block triangle of the result
+    int mat_size = n * n;
+    double *a = make_mat(mat_size), *l = make_mat(mat_size);
+    double *c = make_mat(mat_size);
+    x_mat.to_dense(a);
+    r_mat.to_dense(l);
+    for (int j = 1; j < n; j++)
+        memset(&l[j * n], 0, j * sizeof(*l));
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, n, n, n, 1.0, l, n, l,
+                n, 0.0, c, n);
+
+    if (verbose) {
+        std::cout << "L * L**T = (should be equal to A)" << std::endl;
+        print_mat('c', c, n, n);
+    }
+    bool equal = mat_equal(c, a, mat_size, 1e-12);
+    mkl_free(a);
+    mkl_free(l);
+    mkl_free(c);
+    return equal;
+}
+
+bool OocCholesky::validate(bool verbose) {
+    // Freivalds on the tiles: L * (L**T * x) == A * x for a random x
+    double *x = make_random_mat(n), *t = make_mat(n);
+    double *y = make_mat(n), *z = make_mat(n);
+    r_mat.multiply(x, t, true, true);
+    r_mat.multiply(t, y, false, true);
+    x_mat.multiply(x, z, false, false);
+    cblas_daxpy(n, -1.0, y, 1, z, 1);
+
+    double a_norm = x_mat.norm();
+    bool ok = check_ratio("|(A-L*L**T)*x|", norm(z, n), a_norm * norm(x, n), n);
+    mkl_free(x);
+    mkl_free(t);
+    mkl_free(y);
+    mkl_free(z);
+    return ok;
+}
+
+void OocCholesky::print_args() {
+    std::cout << "Out-of-core Cholesky decomposition, A = L * L**T, with "
+              << tile << "*" << tile << " tiles." << std::endl;
+    std::cout << "A =" << std::endl;
+    double *x = make_mat(n * n);
+    x_mat.to_dense(x);
+    print_mat('c', x, n, n);
+    mkl_free(x);
+}
+
+void OocCholesky::print_result() {
+    // the strict upper block triangle still holds A
+    std::cout << "L (lower triangle) =" << std::endl;
+    double *x = make_mat(n * n);
+    r_mat.to_dense(x);
+    print_mat('c', x, n, n);
+    mkl_free(x);
+}
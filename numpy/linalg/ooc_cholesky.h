@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "tiled_matrix.h"
+
+class OocCholesky : public Bench {
+  public:
+    OocCholesky(const OocConfig &config);
+    ~OocCholesky();
+    void make_args(int size);
+    void copy_args();
+    void clean_args();
+    bool test(bool verbose);
+    bool validate(bool verbose);
+    void print_args();
+    void print_result();
+    void compute();
+    void print_stats(double seconds);
+
+  private:
+    void make_tiles(int size, int tile);
+
+    OocConfig config;
+    TiledMatrix x_mat, r_mat;
+    TileStream stream;
+    std::vector<std::vector<TileRef> > schedule;
+    double *acc, *diag;
+    int n, tile;
+};
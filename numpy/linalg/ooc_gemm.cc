@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ooc_gemm.h"
+#include <cstring>
+#include <iostream>
+
+static const int test_size = 5;
+static const int test_tile = 2;
+
+// in memory: the accumulator tile plus a double-buffered pair of A, B tiles
+static const int resident_tiles = 5;
+
+OocGemm::OocGemm(const OocConfig &config) : config(config) {
+    acc = 0;
+    n = tile = 0;
+}
+
+void OocGemm::clean_args() {
+    if (acc)
+        mkl_free(acc);
+    acc = 0;
+    stream.clean_buffers();
+    a_mat.release();
+    b_mat.release();
+    r_mat.release();
+}
+
+OocGemm::~OocGemm() {
+    clean_args();
+}
+
+void OocGemm::make_tiles(int size, int tile_order) {
+    n = size;
+    tile = tile_order;
+
+    a_mat.create(config.dir, n, tile);
+    b_mat.create(config.dir, n, tile);
+    r_mat.create(config.dir, n, tile);
+
+    acc = make_mat(tile * tile);
+    int nt = a_mat.tiles();
+    for (int j = 0; j < nt; j++) {
+        for (int i = 0; i < nt; i++) {
+            fill_random_mat(acc, tile * tile);
+            a_mat.store(i, j, acc);
+            fill_random_mat(acc, tile * tile);
+            b_mat.store(i, j, acc);
+        }
+    }
+
+    // R(i, j) = sum_k A(i, k) * B(k, j), one block column of R at a time
+    schedule.clear();
+    for (int j = 0; j < nt; j++)
+        for (int i = 0; i < nt; i++)
+            for (int k = 0; k < nt; k++)
+                schedule.push_back({{&a_mat, i, k}, {&b_mat, k, j}});
+
+    stream.make_buffers(tile, 2);
+}
+
+void OocGemm::make_args(int size) {
+    make_tiles(size, config.choose_tile(size, resident_tiles));
+}
+
+void OocGemm::copy_args() {
+    // R is overwritten tile by tile, so there is nothing to restore
+}
+
+void OocGemm::compute() {
+    a_mat.reset_counters();
+    b_mat.reset_counters();
+    r_mat.reset_counters();
+
+    int nt = a_mat.tiles();
+    stream.start(&schedule);
+    for (int j = 0; j < nt; j++) {
+        for (int i = 0; i < nt; i++) {
+            memset(acc, 0, tile * tile * sizeof(*acc));
+            for (int k = 0; k < nt; k++) {
+                double *const *t = stream.next();
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans,
+                            a_mat.tile_dim(i), b_mat.tile_dim(j),
+                            a_mat.tile_dim(k), 1.0, t[0], tile, t[1], tile,
+                            1.0, acc, tile);
+            }
+            r_mat.store(i, j, acc);
+        }
+    }
+    stream.finish();
+}
+
+void OocGemm::print_stats(double seconds) {
+    double flops = 2.0 * n * n * (double) n;
+    double read = a_mat.bytes_read + b_mat.bytes_read;
+    double written = r_mat.bytes_written;
+
+    printf("# ooc_gemm: tile %d, %.1f MiB resident, %.3f GFLOP/s, "
+           "read %.3f GB/s, write %.3f GB/s\n",
+           tile, resident_tiles * a_mat.tile_bytes() / 1048576.0,
+           flops / seconds * 1e-9, read / seconds * 1e-9,
+           written / seconds * 1e-9);
+}
+
+bool OocGemm::test(bool verbose) {
+    clean_args();
+    make_tiles(test_size, test_tile);
+    copy_args();
+    compute();
+
+    int mat_size = n * n;
+    double *a = make_mat(mat_size), *b = make_mat(mat_size);
+    double *r = make_mat(mat_size), *c = make_mat(mat_size);
+    a_mat.to_dense(a);
+    b_mat.to_dense(b);
+    r_mat.to_dense(r);
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, n, n, 1.0, a, n,
+                b, n, 0.0, c, n);
+
+    if (verbose) {
+        std::cout << "A * B in memory = (should be equal to result)"
+                  << std::endl;
+        print_mat('c', c, n, n);
+    }
+    bool equal = mat_equal(r, c, mat_size, 1e-12);
+    mkl_free(a);
+    mkl_free(b);
+    mkl_free(r);
+    mkl_free(c);
+    return equal;
+}
+
+bool OocGemm::validate(bool verbose) {
+    // Freivalds on the tiles: A * (B * x) == R * x for a random x
+    double *x = make_random_mat(n), *t = make_mat(n);
+    double *y = make_mat(n), *z = make_mat(n);
+    b_mat.multiply(x, t, false, false);
+    a_mat.multiply(t, y, false, false);
+    r_mat.multiply(x, z, false, false);
+    cblas_daxpy(n, -1.0, y, 1, z, 1);
+
+    bool ok = check_ratio("|(A*B-R)*x|", norm(z, n),
+                          a_mat.norm() * b_mat.norm() * norm(x, n), n);
+    mkl_free(x);
+    mkl_free(t);
+    mkl_free(y);
+    mkl_free(z);
+    return ok;
+}
+
+void OocGemm::print_args() {
+    std::cout << "Out-of-core matrix multiplication A * B with " << tile
+              << "*" << tile << " tiles." << std::endl;
+    double *x = make_mat(n * n);
+    std::cout << "A =" << std::endl;
+    a_mat.to_dense(x);
+    print_mat('c', x, n, n);
+    std::cout << "B =" << std::endl;
+    b_mat.to_dense(x);
+    print_mat('c', x, n, n);
+    mkl_free(x);
+}
+
+void OocGemm::print_result() {
+    std::cout << "A * B =" << std::endl;
+    double *x = make_mat(n * n);
+    r_mat.to_dense(x);
+    print_mat('c', x, n, n);
+    mkl_free(x);
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "pipeline.h"
+#include "timer.h"
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Below this share of the serial time, copy_args() prepares nothing that
+// could overlap, e.g. because the bench copies inside compute(), and the
+// Hidden ratio would only amplify timing noise.
+static const double min_copy_share = 0.01;
+
+void print_pipeline_header() {
+    std::cout << "Prefix,Function,Size,Depth,Reps,Copy,Compute,"
+                 "Serial:ops/s,Pipelined:ops/s,Hidden"
+              << std::endl;
+    std::cout << "# Hidden is n/a where copy_args() is under "
+              << 100. * min_copy_share
+              << "% of the serial time: cholesky and svd copy their input "
+                 "inside compute(), gemv, multi_dot*, syrk, syr2k and "
+                 "ooc_gemm have none to restore, and eig copies little next to "
+                 "its compute()"
+              << std::endl;
+}
+
+void run_pipeline(const std::function<Bench *()> &factory,
+                  const std::string &name, const std::string &prefix,
+                  int size, int reps, int depth) {
+    std::vector<Bench *> sets;
+    for (int s = 0; s < depth; s++) {
+        sets.push_back(factory());
+        sets[s]->make_args(size);
+        sets[s]->copy_args();
+        sets[s]->compute();
+    }
+
+    // Serial reference, the same loop as the default mode, but with
+    // copy_args() timed as well.
+    double copy_time = 0., compute_time = 0.;
+    timer_ticks t_start = timer_start();
+    for (int j = 0; j < reps; j++) {
+        Bench *bench = sets[j % depth];
+        timer_ticks t0 = timer_start();
+        bench->copy_args();
+        timer_ticks t1 = timer_stop();
+        bench->compute();
+        timer_ticks t2 = timer_stop();
+        copy_time += timer_seconds(t0, t1);
+        compute_time += timer_seconds(t1, t2);
+    }
+    double serial_time = timer_seconds(t_start, timer_stop());
+
+    std::cout << prefix << "," << name << "," << size << "," << depth << ","
+              << reps << "," << copy_time / reps << "," << compute_time / reps
+              << "," << reps / serial_time << ",";
+    if (copy_time < min_copy_share * serial_time) {
+        std::cout << "n/a,n/a" << std::endl;
+        std::cout << "# pipeline " << name << ": copy_args() is "
+                  << 100. * copy_time / serial_time
+                  << "% of the serial time, nothing to overlap" << std::endl;
+        for (auto bench : sets)
+            delete bench;
+        return;
+    }
+
+    // ready[s] is set by the producer once set s holds fresh arguments and
+    // cleared by the consumer once compute() on it has returned
+    std::vector<bool> ready(depth, false);
+    std::mutex mutex;
+    std::condition_variable cond;
+
+    t_start = timer_start();
+    std::thread producer([&]() {
+        for (int j = 0; j < reps; j++) {
+            int s = j % depth;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock, [&]() { return !ready[s]; });
+            }
+            sets[s]->copy_args();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready[s] = true;
+            }
+            cond.notify_all();
+        }
+    });
+
+    for (int j = 0; j < reps; j++) {
+        int s = j % depth;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [&]() { return (bool) ready[s]; });
+        }
+        sets[s]->compute();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready[s] = false;
+        }
+        cond.notify_all();
+    }
+    producer.join();
+    double pipelined_time = timer_seconds(t_start, timer_stop());
+
+    // Share of the copy cost that overlapped with compute(). It can go
+    // below zero when the producer slows compute() down by more than the
+    // copies it hides, e.g. by competing for memory bandwidth.
+    double hidden = (serial_time - pipelined_time) / copy_time;
+
+    std::cout << reps / pipelined_time << "," << hidden << std::endl;
+
+    for (auto bench : sets)
+        delete bench;
+}
@@ -0,0 +1,19 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+#include "bench.h"
+#include <functional>
+#include <string>
+
+// Pipelined mode: `depth` independent argument sets, a producer thread
+// running copy_args() on set i + 1 while compute() runs on set i. Benches
+// whose copy_args() does next to no work, e.g. cholesky and svd, which
+// copy inside compute(), report n/a instead; the header lists them.
+void print_pipeline_header();
+void run_pipeline(const std::function<Bench *()> &factory,
+                  const std::string &name, const std::string &prefix,
+                  int size, int reps, int depth);
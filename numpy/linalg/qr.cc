@@ -82,6 +82,32 @@ bool QR::test(bool verbose) {
            mat_equal(r_mat, r_mat_test, mat_size);
 }
 
+bool QR::validate(bool verbose) {
+    // |A - Q * R| / |A| and |Q**T * Q - I|, with Q formed from the
+    // Householder reflectors left in x_mat
+    double *q = make_mat(mat_size), *c = make_mat(mat_size);
+    memcpy(q, x_mat, mat_size * sizeof(*q));
+    int info = LAPACKE_dorgqr(LAPACK_COL_MAJOR, n, n, n, q, lda, tau_vec);
+    assert(info == 0);
+
+    memcpy(c, x_mat_init, mat_size * sizeof(*c));
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, n, n, -1.0, q, n,
+                r_mat, n, 1.0, c, n);
+    bool ok = check_ratio("|A-Q*R|", norm(c, mat_size),
+                          norm(x_mat_init, mat_size), n);
+
+    memset(c, 0, mat_size * sizeof(*c));
+    for (int i = 0; i < n; i++)
+        c[i * n + i] = 1.0;
+    cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, n, n, n, 1.0, q, n, q,
+                n, -1.0, c, n);
+    ok = check_ratio("|Q**T*Q-I|", norm(c, mat_size), 1.0, n) && ok;
+
+    mkl_free(q);
+    mkl_free(c);
+    return ok;
+}
+
 void QR::print_args() {
     std::cout << "QR decomposition of " << n << "*" << n << " matrix A."
               << std::endl;
@@ -77,6 +77,38 @@ bool SVD::test(bool verbose) {
            mat_equal(vt_mat, vt_mat_test, mat_size);
 }
 
+bool SVD::validate(bool verbose) {
+    // |A - U * S * V**T| / |A|, |U**T * U - I| and |V**T * V - I|
+    double *w = make_mat(mat_size), *c = make_mat(mat_size);
+    memcpy(w, u_mat, mat_size * sizeof(*w));
+    for (int j = 0; j < n; j++)
+        cblas_dscal(n, s_vec[j], &w[j * n], 1);
+    memcpy(c, a_mat, mat_size * sizeof(*c));
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, n, n, -1.0, w, n,
+                vt_mat, n, 1.0, c, n);
+    bool ok = check_ratio("|A-U*S*V**T|", norm(c, mat_size),
+                          norm(a_mat, mat_size), n);
+
+    for (int pass = 0; pass < 2; pass++) {
+        memset(c, 0, mat_size * sizeof(*c));
+        for (int i = 0; i < n; i++)
+            c[i * n + i] = 1.0;
+        if (pass == 0)
+            cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, n, n, n, 1.0,
+                        u_mat, n, u_mat, n, -1.0, c, n);
+        else
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, n, n, n, 1.0,
+                        vt_mat, n, vt_mat, n, -1.0, c, n);
+        ok = check_ratio(pass == 0 ? "|U**T*U-I|" : "|V**T*V-I|",
+                         norm(c, mat_size), 1.0, n) &&
+             ok;
+    }
+
+    mkl_free(w);
+    mkl_free(c);
+    return ok;
+}
+
 void SVD::print_args() {
     std::cout << "Singular value decomposition of " << n << "*" << n
               << " matrix A." << std::endl;
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "syr2k.h"
+#include <cstring>
+#include <iostream>
+
+static const double a_mat_test[] = {
+    0.470442000675409,  -0.176333746005435, 0.481736547564898,
+    -0.291482508170914, 0.007410393215614,  0.805743972141035,
+    -0.44183986349643,  -0.739195206041762, -0.468344563609981};
+
+static const double b_mat_test[] = {
+    -0.279551412836935, -1.866235595807669, 0.949267732307811,
+    0.393910888693485,  0.357832357041521,  1.430099195743549,
+    -0.202579028296422, -1.225349132812327, 0.535350173863021};
+
+static const double r_mat_test[] = {
+    1.309729095335062, 1.643666916472071,  1.437111445898587,
+    1.643666916472071, 2.080254702345687,  -0.627009579986400,
+    1.437111445898587, -0.627009579986400, 1.489102702711258};
+
+static const int test_size = 3;
+
+Syr2k::Syr2k() {
+    a_mat = b_mat = r_mat = 0;
+}
+
+void Syr2k::clean_args() {
+    if (a_mat)
+        mkl_free(a_mat);
+    if (b_mat)
+        mkl_free(b_mat);
+    if (r_mat)
+        mkl_free(r_mat);
+}
+
+Syr2k::~Syr2k() {
+    clean_args();
+}
+
+void Syr2k::make_args(int size) {
+    n = k = size;
+
+    a_mat = make_random_mat(n * k);
+    b_mat = make_random_mat(n * k);
+    r_mat = make_mat(n * n);
+
+    copy_args();
+}
+
+void Syr2k::copy_args() {
+    // beta == 0, so r_mat is never read
+}
+
+void Syr2k::compute() {
+    double alpha = 1.0;
+    double beta = 0.0;
+
+    // A * B.T + B * A.T
+    cblas_dsyr2k(CblasRowMajor, CblasUpper, CblasNoTrans, n, k, alpha, a_mat,
+                 k, b_mat, k, beta, r_mat, n);
+    mirror_upper(r_mat, n);
+}
+
+bool Syr2k::test(bool verbose) {
+    clean_args();
+    make_args(test_size);
+    memcpy(a_mat, a_mat_test, n * k * sizeof(*a_mat));
+    memcpy(b_mat, b_mat_test, n * k * sizeof(*b_mat));
+    copy_args();
+    compute();
+
+    return mat_equal(r_mat, r_mat_test, n * n);
+}
+
+bool Syr2k::validate(bool verbose) {
+    // Freivalds: A * (B**T * x) + B * (A**T * x) == R * x for a random x
+    double *x = make_random_mat(n), *t = make_mat(k);
+    double *y = make_mat(n), *z = make_mat(n);
+    cblas_dgemv(CblasRowMajor, CblasTrans, n, k, 1.0, b_mat, k, x, 1, 0.0, t,
+                1);
+    cblas_dgemv(CblasRowMajor, CblasNoTrans, n, k, 1.0, a_mat, k, t, 1, 0.0,
+                y, 1);
+    cblas_dgemv(CblasRowMajor, CblasTrans, n, k, 1.0, a_mat, k, x, 1, 0.0, t,
+                1);
+    cblas_dgemv(CblasRowMajor, CblasNoTrans, n, k, 1.0, b_mat, k, t, 1, 1.0,
+                y, 1);
+    cblas_dgemv(CblasRowMajor, CblasNoTrans, n, n, 1.0, r_mat, n, x, 1, 0.0,
+                z, 1);
+    cblas_daxpy(n, -1.0, y, 1, z, 1);
+
+    bool ok = check_ratio("|(A*B**T+B*A**T-R)*x|", norm(z, n),
+                          2 * norm(a_mat, n * k) * norm(b_mat, n * k) *
+                              norm(x, n),
+                          k);
+    mkl_free(x);
+    mkl_free(t);
+    mkl_free(y);
+    mkl_free(z);
+    return ok;
+}
+
+void Syr2k::print_args() {
+    std::cout << "Symmetric rank-2k update A * B**T + B * A**T." << std::endl;
+    std::cout << "A =" << std::endl;
+    print_mat('r', a_mat, n, k);
+    std::cout << "B =" << std::endl;
+    print_mat('r', b_mat, n, k);
+}
+
+void Syr2k::print_result() {
+    std::cout << "A * B**T + B * A**T =" << std::endl;
+    print_mat('r', r_mat, n, n);
+}
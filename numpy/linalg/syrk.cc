@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "syrk.h"
+#include <cstring>
+#include <iostream>
+
+static const double a_mat_test[] = {
+    0.470442000675409,  -0.176333746005435, 0.481736547564898,
+    -0.291482508170914, 0.007410393215614,  0.805743972141035,
+    -0.44183986349643,  -0.739195206041762, -0.468344563609981};
+
+static const double r_mat_test[] = {
+    0.484479367239538,  0.249724002659556,  -0.303133662795068,
+    0.249724002659556,  0.734240315138830,  -0.254054944531798,
+    -0.303133662795068, -0.254054944531798, 0.960978647872691};
+
+static const int test_size = 3;
+
+Syrk::Syrk() {
+    a_mat = r_mat = 0;
+}
+
+void Syrk::clean_args() {
+    if (a_mat)
+        mkl_free(a_mat);
+    if (r_mat)
+        mkl_free(r_mat);
+}
+
+Syrk::~Syrk() {
+    clean_args();
+}
+
+void Syrk::make_args(int size) {
+    n = k = size;
+
+    a_mat = make_random_mat(n * k);
+    r_mat = make_mat(n * n);
+
+    copy_args();
+}
+
+void Syrk::copy_args() {
+    // beta == 0, so r_mat is never read
+}
+
+void Syrk::compute() {
+    double alpha = 1.0;
+    double beta = 0.0;
+
+    // A * A.T: half the flops of the equivalent dgemm
+    cblas_dsyrk(CblasRowMajor, CblasUpper, CblasNoTrans, n, k, alpha, a_mat, k,
+                beta, r_mat, n);
+    mirror_upper(r_mat, n);
+}
+
+bool Syrk::test(bool verbose) {
+    clean_args();
+    make_args(test_size);
+    memcpy(a_mat, a_mat_test, n * k * sizeof(*a_mat));
+    copy_args();
+    compute();
+
+    return mat_equal(r_mat, r_mat_test, n * n);
+}
+
+bool Syrk::validate(bool verbose) {
+    // Freivalds: A * (A**T * x) == R * x for a random x
+    double *x = make_random_mat(n), *t = make_mat(k);
+    double *y = make_mat(n), *z = make_mat(n);
+    cblas_dgemv(CblasRowMajor, CblasTrans, n, k, 1.0, a_mat, k, x, 1, 0.0, t,
+                1);
+    cblas_dgemv(CblasRowMajor, CblasNoTrans, n, k, 1.0, a_mat, k, t, 1, 0.0,
+                y, 1);
+    cblas_dgemv(CblasRowMajor, CblasNoTrans, n, n, 1.0, r_mat, n, x, 1, 0.0,
+                z, 1);
+    cblas_daxpy(n, -1.0, y, 1, z, 1);
+
+    double a_norm = norm(a_mat, n * k);
+    bool ok =
+        check_ratio("|(A*A**T-R)*x|", norm(z, n), a_norm * a_norm * norm(x, n),
+                    k);
+    mkl_free(x);
+    mkl_free(t);
+    mkl_free(y);
+    mkl_free(z);
+    return ok;
+}
+
+void Syrk::print_args() {
+    std::cout << "Symmetric rank-k update A * A**T." << std::endl;
+    std::cout << "A =" << std::endl;
+    print_mat('r', a_mat, n, k);
+}
+
+void Syrk::print_result() {
+    std::cout << "A * A**T =" << std::endl;
+    print_mat('r', r_mat, n, n);
+}
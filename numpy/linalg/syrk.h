@@ -0,0 +1,25 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "bench.h"
+
+class Syrk : public Bench {
+  public:
+    Syrk();
+    ~Syrk();
+    void make_args(int size);
+    void copy_args();
+    void clean_args();
+    bool test(bool verbose);
+    bool validate(bool verbose);
+    void print_args();
+    void print_result();
+    void compute();
+
+  private:
+    double *a_mat, *r_mat;
+    int n, k;
+};
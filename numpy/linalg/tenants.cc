@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "tenants.h"
+#include "timer.h"
+#include <iostream>
+#include <sched.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+struct Instance {
+    pid_t pid;
+    int ready_fd, result_fd;
+    double start, end;
+    std::vector<double> times;
+};
+
+static double now() {
+    // the system clock rather than the TSC, comparable between processes
+    // whether or not they run on the same socket
+    return timer_clock_ns() * 1e-9;
+}
+
+static std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; c++)
+            if (CPU_ISSET(c, &set))
+                cpus.push_back(c);
+    }
+    return cpus;
+}
+
+static bool write_all(int fd, const void *buf, size_t len) {
+    const char *p = (const char *) buf;
+    while (len > 0) {
+        ssize_t w = write(fd, p, len);
+        if (w <= 0)
+            return false;
+        p += w;
+        len -= w;
+    }
+    return true;
+}
+
+static bool read_all(int fd, void *buf, size_t len) {
+    char *p = (char *) buf;
+    while (len > 0) {
+        ssize_t r = read(fd, p, len);
+        if (r <= 0)
+            return false;
+        p += r;
+        len -= r;
+    }
+    return true;
+}
+
+// false if the bench could not be set up
+static bool run_child(Bench *bench, int size, int reps, int threads,
+                      const std::vector<int> &cores, int ready_fd, int go_fd,
+                      int result_fd) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : cores)
+        CPU_SET(c, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+    set_backend_threads(threads);
+
+    // tell the parent we are set up, or failed to, then wait until every
+    // tenant is
+    char c = 0;
+    try {
+        bench->make_args(size);
+        bench->copy_args();
+        bench->compute();
+    } catch (const std::exception &ex) {
+        std::cerr << "error: " << ex.what() << std::endl;
+        c = 1;
+    }
+    write_all(ready_fd, &c, 1);
+    if (c)
+        return false;
+    read(go_fd, &c, 1);
+
+    std::vector<double> times(reps);
+    double start = now();
+    for (int j = 0; j < reps; j++) {
+        bench->copy_args();
+        double t0 = now();
+        bench->compute();
+        times[j] = now() - t0;
+    }
+    double end = now();
+
+    write_all(result_fd, &start, sizeof(start));
+    write_all(result_fd, &end, sizeof(end));
+    write_all(result_fd, times.data(), reps * sizeof(double));
+    return true;
+}
+
+// Undo a failed run: kill and reap the first `started` instances before
+// the caller closes go, so none of them is released to run its reps.
+static void abort_instances(std::vector<Instance> &instances, int started) {
+    for (int k = 0; k < started; k++) {
+        kill(instances[k].pid, SIGKILL);
+        waitpid(instances[k].pid, nullptr, 0);
+        close(instances[k].ready_fd);
+        close(instances[k].result_fd);
+    }
+}
+
+// Fork `count` instances, release them at once and collect their timings.
+static bool run_instances(Bench *bench, int size, int reps, int count,
+                          int threads, std::vector<Instance> &instances) {
+    std::vector<int> cpus = allowed_cpus();
+    if ((size_t) count * threads > cpus.size())
+        std::cerr << "# warning: " << count << " tenants * " << threads
+                  << " threads oversubscribe " << cpus.size() << " cores"
+                  << std::endl;
+
+    int go[2];
+    if (pipe(go) != 0)
+        return false;
+
+    // don't let children flush a copy of buffered output
+    std::cout.flush();
+    fflush(stdout);
+
+    instances.assign(count, Instance());
+    for (int k = 0; k < count; k++) {
+        int ready[2], result[2];
+        if (pipe(ready) != 0) {
+            abort_instances(instances, k);
+            close(go[0]);
+            close(go[1]);
+            return false;
+        }
+        if (pipe(result) != 0) {
+            close(ready[0]);
+            close(ready[1]);
+            abort_instances(instances, k);
+            close(go[0]);
+            close(go[1]);
+            return false;
+        }
+
+        std::vector<int> cores;
+        for (int t = 0; t < threads && !cpus.empty(); t++)
+            cores.push_back(cpus[(k * threads + t) % cpus.size()]);
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(ready[0]);
+            close(go[1]);
+            close(result[0]);
+            bool ok = run_child(bench, size, reps, threads, cores, ready[1],
+                                go[0], result[1]);
+            _exit(ok ? 0 : 1);
+        }
+        close(ready[1]);
+        close(result[1]);
+        if (pid < 0) {
+            close(ready[0]);
+            close(result[0]);
+            abort_instances(instances, k);
+            close(go[0]);
+            close(go[1]);
+            return false;
+        }
+        instances[k].pid = pid;
+        instances[k].ready_fd = ready[0];
+        instances[k].result_fd = result[0];
+    }
+    close(go[0]);
+
+    // each instance has its own ready pipe, so one that dies before it is
+    // set up reads as EOF here instead of hanging on a sibling's open end
+    for (auto &inst : instances) {
+        char c;
+        if (!read_all(inst.ready_fd, &c, 1) || c != 0) {
+            abort_instances(instances, count);
+            close(go[1]);
+            return false;
+        }
+    }
+    for (auto &inst : instances)
+        close(inst.ready_fd);
+    // closing the write end makes every waiting read() return at once
+    close(go[1]);
+
+    bool ok = true;
+    for (auto &inst : instances) {
+        inst.times.resize(reps);
+        ok = ok && read_all(inst.result_fd, &inst.start, sizeof(double)) &&
+             read_all(inst.result_fd, &inst.end, sizeof(double)) &&
+             read_all(inst.result_fd, inst.times.data(),
+                      reps * sizeof(double));
+        close(inst.result_fd);
+
+        int status;
+        waitpid(inst.pid, &status, 0);
+        ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    return ok;
+}
+
+static double percentile(std::vector<double> v, double p) {
+    // nearest rank
+    sort(v.begin(), v.end());
+    size_t rank = (size_t) (p / 100.0 * v.size() + 0.5);
+    rank = min(max(rank, (size_t) 1), v.size());
+    return v[rank - 1];
+}
+
+static void print_row(const std::string &prefix, const std::string &name,
+                      int size, int tenants, int threads,
+                      const std::string &instance,
+                      const std::vector<double> &times, double solo_p50,
+                      double throughput) {
+    double p50 = percentile(times, 50);
+    std::cout << prefix << "," << name << "," << size << "," << tenants << ","
+              << threads << "," << instance << "," << times.size() << ","
+              << p50 << "," << percentile(times, 90) << ","
+              << percentile(times, 99) << "," << percentile(times, 100)
+              << "," << p50 / solo_p50 << "," << throughput << std::endl;
+}
+
+void print_tenants_header() {
+    std::cout << "Prefix,Function,Size,Tenants,Threads,Instance,Reps,"
+                 "Time:p50,Time:p90,Time:p99,Time:max,Slowdown,Throughput"
+              << std::endl;
+}
+
+bool run_tenants(Bench *bench, const std::string &name,
+                 const std::string &prefix, int size, int reps, int tenants,
+                 int threads) {
+    std::vector<Instance> solo, shared;
+    if (!run_instances(bench, size, reps, 1, threads, solo) ||
+        !run_instances(bench, size, reps, tenants, threads, shared)) {
+        std::cerr << "error: tenant run failed for " << name << std::endl;
+        return false;
+    }
+
+    double solo_p50 = percentile(solo[0].times, 50);
+    print_row(prefix, name, size, 1, threads, "solo", solo[0].times, solo_p50,
+              reps / (solo[0].end - solo[0].start));
+
+    // Slowdown is relative to the solo median, i.e. the interference
+    // between tenants; the aggregate throughput counts every call made
+    // from the first start to the last finish.
+    std::vector<double> all;
+    double start = shared[0].start, end = shared[0].end;
+    for (int k = 0; k < tenants; k++) {
+        print_row(prefix, name, size, tenants, threads, std::to_string(k),
+                  shared[k].times, solo_p50,
+                  reps / (shared[k].end - shared[k].start));
+        all.insert(all.end(), shared[k].times.begin(), shared[k].times.end());
+        start = min(start, shared[k].start);
+        end = max(end, shared[k].end);
+    }
+    print_row(prefix, name, size, tenants, threads, "all", all, solo_p50,
+              all.size() / (end - start));
+    return true;
+}
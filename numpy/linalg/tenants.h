@@ -0,0 +1,17 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+#include "bench.h"
+#include <string>
+
+// Multi-tenant throughput mode: run a solo instance of the bench, then
+// `tenants` concurrent instances in forked processes, each pinned to its
+// own set of `threads` cores with that many backend threads.
+void print_tenants_header();
+bool run_tenants(Bench *bench, const std::string &name,
+                 const std::string &prefix, int size, int reps, int tenants,
+                 int threads);
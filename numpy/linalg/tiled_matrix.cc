@@ -0,0 +1,293 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "tiled_matrix.h"
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+
+// statfs f_type of tmpfs, from linux/magic.h
+static const long tmpfs_magic = 0x01021994;
+
+OocConfig::OocConfig() {
+    // not $TMPDIR or /tmp, which are often tmpfs and would time memory
+    // copies instead of the disk
+    dir = "/var/tmp";
+    memory = (size_t) 256 << 20;
+    tile = 0;
+}
+
+int OocConfig::choose_tile(int n, int resident_tiles) const {
+    int t = tile;
+    if (t <= 0) {
+        t = (int) sqrt((double) memory / (resident_tiles * sizeof(double)));
+        // keep tiles a multiple of a cache line of doubles
+        if (t > 8)
+            t -= t % 8;
+    }
+    return max(1, min(t, n));
+}
+
+static size_t page_size() {
+    return (size_t) sysconf(_SC_PAGESIZE);
+}
+
+static void fail(const std::string &what, int err) {
+    throw std::runtime_error(what + ": " + strerror(err));
+}
+
+static void warn_if_tmpfs(const std::string &dir) {
+    static std::string warned;
+    struct statfs fs;
+    if (dir == warned || statfs(dir.c_str(), &fs) != 0 ||
+        (long) fs.f_type != tmpfs_magic)
+        return;
+    warned = dir;
+    std::cerr << "# warning: " << dir << " is on tmpfs, so out-of-core I/O "
+              << "is memory copies; pass --ooc-dir on a local disk"
+              << std::endl;
+}
+
+TiledMatrix::TiledMatrix() : bytes_read(0), bytes_written(0) {
+    map = 0;
+    fd = -1;
+    map_bytes = slot_bytes = 0;
+    n = tile = nt = 0;
+}
+
+TiledMatrix::~TiledMatrix() {
+    release();
+}
+
+void TiledMatrix::create(const std::string &dir, int size, int tile_order) {
+    release();
+
+    n = size;
+    tile = tile_order;
+    nt = (n + tile - 1) / tile;
+
+    size_t page = page_size();
+    slot_bytes = tile_bytes();
+    slot_bytes = (slot_bytes + page - 1) / page * page;
+    map_bytes = slot_bytes * nt * nt;
+
+    warn_if_tmpfs(dir);
+    std::string path = dir + "/linalg_ooc_XXXXXX";
+    std::vector<char> name(path.begin(), path.end());
+    name.push_back('\0');
+
+    fd = mkstemp(name.data());
+    if (fd < 0)
+        fail("cannot create a file in " + dir, errno);
+    unlink(name.data());
+
+    // Reserve the blocks now, so that a full disk fails here rather than
+    // with SIGBUS on a store. Unwritten tile padding reads back as zeros.
+    int err = posix_fallocate(fd, 0, (off_t) map_bytes);
+    if (err != 0) {
+        release();
+        fail("cannot allocate " + std::to_string(map_bytes) + " bytes in " +
+                 dir,
+             err);
+    }
+
+    void *p = mmap(0, map_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        err = errno;
+        release();
+        fail("cannot map a file in " + dir, err);
+    }
+
+    map = (char *) p;
+    reset_counters();
+}
+
+void TiledMatrix::release() {
+    if (map)
+        munmap(map, map_bytes);
+    if (fd >= 0)
+        close(fd);
+    map = 0;
+    fd = -1;
+}
+
+int TiledMatrix::size() const {
+    return n;
+}
+
+int TiledMatrix::tile_order() const {
+    return tile;
+}
+
+int TiledMatrix::tiles() const {
+    return nt;
+}
+
+int TiledMatrix::tile_dim(int i) const {
+    return min(tile, n - i * tile);
+}
+
+size_t TiledMatrix::tile_bytes() const {
+    return (size_t) tile * tile * sizeof(double);
+}
+
+char *TiledMatrix::slot(int i, int j) {
+    // tiles of one block column are adjacent, as the drivers walk columns
+    return map + ((size_t) j * nt + i) * slot_bytes;
+}
+
+// write a dirty slot back to the disk before it is dropped
+void TiledMatrix::flush(char *p) {
+    if (msync(p, slot_bytes, MS_SYNC) != 0)
+        fail("cannot write back a tile", errno);
+    drop(p);
+}
+
+void TiledMatrix::drop(char *p) {
+    madvise(p, slot_bytes, MADV_DONTNEED);
+    // clean pages only, which is why stores flush() first
+    posix_fadvise(fd, p - map, slot_bytes, POSIX_FADV_DONTNEED);
+}
+
+void TiledMatrix::load(int i, int j, double *buf) {
+    char *p = slot(i, j);
+    memcpy(buf, p, tile_bytes());
+    drop(p);
+    bytes_read += tile_bytes();
+}
+
+void TiledMatrix::store(int i, int j, const double *buf) {
+    char *p = slot(i, j);
+    memcpy(p, buf, tile_bytes());
+    flush(p);
+    bytes_written += tile_bytes();
+}
+
+void TiledMatrix::copy_from(TiledMatrix &other) {
+    assert(other.n == n && other.tile == tile);
+    for (int j = 0; j < nt; j++) {
+        for (int i = 0; i < nt; i++) {
+            memcpy(slot(i, j), other.slot(i, j), tile_bytes());
+            flush(slot(i, j));
+            other.drop(other.slot(i, j));
+        }
+    }
+}
+
+void TiledMatrix::to_dense(double *out) {
+    for (int col = 0; col < n; col++) {
+        for (int row = 0; row < n; row++) {
+            double *t = (double *) slot(row / tile, col / tile);
+            out[(size_t) col * n + row] = t[(col % tile) * tile + row % tile];
+        }
+    }
+}
+
+void TiledMatrix::multiply(const double *x, double *y, bool trans,
+                           bool lower_only) {
+    memset(y, 0, (size_t) n * sizeof(*y));
+    for (int j = 0; j < nt; j++) {
+        for (int i = lower_only ? j : 0; i < nt; i++) {
+            char *t = slot(i, j);
+            int rows = tile_dim(i), cols = tile_dim(j);
+            if (trans)
+                cblas_dgemv(CblasColMajor, CblasTrans, rows, cols, 1.0,
+                            (double *) t, tile, &x[i * tile], 1, 1.0,
+                            &y[j * tile], 1);
+            else
+                cblas_dgemv(CblasColMajor, CblasNoTrans, rows, cols, 1.0,
+                            (double *) t, tile, &x[j * tile], 1, 1.0,
+                            &y[i * tile], 1);
+            drop(t);
+        }
+    }
+}
+
+double TiledMatrix::norm() {
+    double sum = 0.;
+    for (int j = 0; j < nt; j++) {
+        for (int i = 0; i < nt; i++) {
+            char *t = slot(i, j);
+            for (int col = 0; col < tile_dim(j); col++) {
+                double c = cblas_dnrm2(tile_dim(i),
+                                       (double *) t + (size_t) col * tile, 1);
+                sum += c * c;
+            }
+            drop(t);
+        }
+    }
+    return sqrt(sum);
+}
+
+void TiledMatrix::reset_counters() {
+    bytes_read = 0;
+    bytes_written = 0;
+}
+
+TileStream::TileStream() {
+    schedule = 0;
+    step = 0;
+}
+
+TileStream::~TileStream() {
+    clean_buffers();
+}
+
+void TileStream::make_buffers(int tile, int width) {
+    clean_buffers();
+    for (int b = 0; b < 2; b++) {
+        for (int w = 0; w < width; w++) {
+            double *buf = (double *) mkl_malloc(
+                (size_t) tile * tile * sizeof(double), 64);
+            assert(buf);
+            buffers[b].push_back(buf);
+        }
+    }
+}
+
+void TileStream::clean_buffers() {
+    finish();
+    for (int b = 0; b < 2; b++) {
+        for (auto buf : buffers[b])
+            mkl_free(buf);
+        buffers[b].clear();
+    }
+}
+
+void TileStream::fetch(int s) {
+    const std::vector<TileRef> &refs = (*schedule)[s];
+    assert(refs.size() <= buffers[s % 2].size());
+    for (size_t r = 0; r < refs.size(); r++)
+        refs[r].mat->load(refs[r].i, refs[r].j, buffers[s % 2][r]);
+}
+
+void TileStream::start(const std::vector<std::vector<TileRef> > *steps) {
+    finish();
+    schedule = steps;
+    step = 0;
+    if (!schedule->empty())
+        pending = std::async(std::launch::async, &TileStream::fetch, this, 0);
+}
+
+double *const *TileStream::next() {
+    pending.get();
+    int s = step++;
+    if (step < (int) schedule->size())
+        pending =
+            std::async(std::launch::async, &TileStream::fetch, this, step);
+    return buffers[s % 2].data();
+}
+
+void TileStream::finish() {
+    if (pending.valid())
+        pending.get();
+}
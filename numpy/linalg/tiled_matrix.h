@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+#include "bench.h"
+
+#include <atomic>
+#include <cstddef>
+#include <future>
+#include <string>
+#include <vector>
+
+// Settings shared by the out-of-core benches, filled from the command line.
+struct OocConfig {
+    std::string dir;    // scratch directory for the backing files, which
+                        // should be on a local disk rather than tmpfs
+    size_t memory;      // budget for in-memory tile buffers, in bytes
+    int tile;           // tile order; 0 derives it from the budget
+
+    OocConfig();
+
+    // Largest tile order such that resident_tiles tiles fit in the budget
+    int choose_tile(int n, int resident_tiles) const;
+};
+
+// Square n x n matrix stored on disk as a grid of tile x tile column-major
+// tiles, one page-aligned slot per tile, and accessed through mmap. The
+// backing file is unlinked as soon as it is created, so it never outlives
+// the process. Stored tiles are written back and every accessed tile is
+// evicted from the page cache, so loads and stores go to the disk.
+class TiledMatrix {
+  public:
+    TiledMatrix();
+    ~TiledMatrix();
+    // throws std::runtime_error if the backing file cannot be set up
+    void create(const std::string &dir, int n, int tile);
+    void release();
+
+    int size() const;
+    int tile_order() const;
+    int tiles() const;
+    // number of rows (or columns) of the i-th tile row (or column)
+    int tile_dim(int i) const;
+    size_t tile_bytes() const;
+
+    // copy tile (i, j) between the mapping and a tile x tile buffer, and
+    // drop the pages from the mapping and the page cache, so that resident
+    // memory stays within budget and the next access reads the disk
+    void load(int i, int j, double *buf);
+    void store(int i, int j, const double *buf);
+    void copy_from(TiledMatrix &other);
+
+    // gather into a column-major n x n buffer, for test and print code
+    void to_dense(double *out);
+
+    // y = M * x, or M**T * x, tile by tile for the untimed validation
+    // pass; lower_only skips the tiles above the diagonal
+    void multiply(const double *x, double *y, bool trans, bool lower_only);
+    // Frobenius norm of the n x n matrix, ignoring tile padding
+    double norm();
+
+    void reset_counters();
+    std::atomic<size_t> bytes_read, bytes_written;
+
+  private:
+    char *slot(int i, int j);
+    void flush(char *p);
+    void drop(char *p);
+
+    char *map;
+    int fd;
+    size_t map_bytes, slot_bytes;
+    int n, tile, nt;
+};
+
+struct TileRef {
+    TiledMatrix *mat;
+    int i, j;
+};
+
+// Replays a fixed schedule of tile loads. Every step loads up to width
+// tiles; while the caller computes on step s, step s + 1 is read into the
+// other half of a double buffer on a separate thread.
+class TileStream {
+  public:
+    TileStream();
+    ~TileStream();
+    void make_buffers(int tile, int width);
+    void clean_buffers();
+
+    void start(const std::vector<std::vector<TileRef> > *schedule);
+    // wait for the next step and return its tiles in schedule order
+    double *const *next();
+    void finish();
+
+  private:
+    void fetch(int step);
+
+    const std::vector<std::vector<TileRef> > *schedule;
+    std::vector<double *> buffers[2];
+    std::future<void> pending;
+    int step;
+};
@@ -5,193 +5,404 @@
  */
 
 #include "mkl.h"
+#include "rng_kernels.h"
 #include "stdio.h"
 #include "stdlib.h"
-#include "time.h"
+#include "string.h"
+#include "timer.h"
+#include <getopt.h>
+#include <limits.h>
+#include <omp.h>
 
-#define SAMPLE_SIZE 100000
 #define INNER_REPS 512
 #define OUTER_REPS 6
+#define PARALLEL_SIZE (1L << 24)
 
-/* mkl_random.uniform(-1,1) */
-extern void sample_uniform(VSLStreamStatePtr stream, MKL_INT sample_size) {
-    int err;
-    double *x;
-    double a = -1.0, b = 1.0;
-    x = (double *) mkl_malloc(sizeof(double) * sample_size, 64);
-
-    err = vdRngUniform(VSL_RNG_METHOD_UNIFORM_STD_ACCURATE, stream, sample_size,
-                       x, a, b);
-    if (err != VSL_STATUS_OK) {
-        printf("Uniform RNG error code: %d\n", err);
-    }
+/*
+ * Fastest of OUTER_REPS timings of INNER_REPS calls of sampling_fn into
+ * out, or into a buffer allocated and freed by every call if out is NULL,
+ * in seconds. Every timing draws from a new stream; *stream_seconds is
+ * lowered to the fastest vslNewStream.
+ */
+static double time_sampler(MKL_INT brng, DistributionSampler sampling_fn,
+                           MKL_INT sz, void *out, double *stream_seconds) {
+    VSLStreamStatePtr stream;
+    int err, outer_it, inner_it;
+    double times[OUTER_REPS];
+    double min_time;
 
-    mkl_free(x);
-}
+    for (outer_it = 0; outer_it < OUTER_REPS; outer_it++) {
+        timer_ticks t_start, t_finish;
+        double t;
 
-/* mkl_random.standard_normal */
-extern void sample_normal(VSLStreamStatePtr stream, MKL_INT sample_size) {
-    int err;
-    double *x;
-    double mu_zero = 0.0, sigma_one = 1.0;
-
-    x = (double *) mkl_malloc(sizeof(double) * sample_size, 64);
-    err = vdRngGaussian(VSL_RNG_METHOD_GAUSSIAN_ICDF, stream, sample_size, x,
-                        mu_zero, sigma_one);
-    if (err != VSL_STATUS_OK) {
-        printf("Normal RNG error code: %d\n", err);
-    }
+        t_start = timer_start();
+        err = vslNewStream(&stream, brng, 123);
+        t_finish = timer_stop();
+        if (err != VSL_STATUS_OK) {
+            printf("PANIC: abandon ship... \n");
+        }
+        t = timer_seconds(t_start, t_finish);
+        if (t < *stream_seconds)
+            *stream_seconds = t;
 
-    mkl_free(x);
-}
+        t_start = timer_start();
+        for (inner_it = 0; inner_it < INNER_REPS; inner_it++) {
+            (*sampling_fn)(stream, sz, out);
+        }
+        t_finish = timer_stop();
 
-/* mkl_random.gamma(5.2, 1) */
-extern void sample_gamma(VSLStreamStatePtr stream, MKL_INT sample_size) {
-    int err;
-    double *x;
-    double shape_par = 5.2, scale_one = 1.0, loc_zero = 0.0;
-
-    x = (double *) mkl_malloc(sizeof(double) * sample_size, 64);
-    err = vdRngGamma(VSL_RNG_METHOD_GAMMA_GNORM_ACCURATE, stream, sample_size,
-                     x, shape_par, loc_zero, scale_one);
-    if (err != VSL_STATUS_OK) {
-        printf("Gamma RNG error code: %d\n", err);
+        times[outer_it] = timer_seconds(t_start, t_finish);
+        vslDeleteStream(&stream);
     }
 
-    mkl_free(x);
+    min_time = times[0];
+    for (outer_it = 1; outer_it < OUTER_REPS; outer_it++)
+        if (times[outer_it] < min_time)
+            min_time = times[outer_it];
+    return min_time;
 }
 
-/* mkl_random.beta(0.7, 2.5) */
-extern void sample_beta(VSLStreamStatePtr stream, MKL_INT sample_size) {
-    int err;
-    double *x;
-    double shape_par1 = 0.7, shape_par2 = 2.5;
-    double loc_zero = 0.0, scale_one = 1.0;
-
-    x = (double *) mkl_malloc(sizeof(double) * sample_size, 64);
-    err = vdRngBeta(VSL_RNG_METHOD_BETA_CJA_ACCURATE, stream, sample_size, x,
-                    shape_par1, shape_par2, loc_zero, scale_one);
-    if (err != VSL_STATUS_OK) {
-        printf("Beta RNG error code: %d\n", err);
-    }
+/*
+ * --threads: every thread draws its part of one array from its own stream.
+ * skipahead threads start the serial stream at their first variate,
+ * leapfrog threads take every threads-th variate of it into contiguous
+ * blocks, and family threads run member t of an MT2203 or WH family,
+ * which is reproducible for a given thread count but never equal to the
+ * serial stream.
+ */
+enum method { SKIPAHEAD, LEAPFROG, FAMILY, N_METHODS };
 
-    mkl_free(x);
-}
+static const char *method_names[N_METHODS] = {"skipahead", "leapfrog",
+                                              "family"};
 
-/* mkl_random.randint(0,100) */
-extern void sample_randint(VSLStreamStatePtr stream, MKL_INT sample_size) {
-    MKL_INT *x;
-    int err;
-    MKL_INT a = 0, b = 100;
+/* members of the BRNG's family, or 0 if it has none */
+static int family_size(MKL_INT brng) {
+    if (brng == VSL_BRNG_MT2203)
+        return 6024;
+    if (brng == VSL_BRNG_WH)
+        return 273;
+    return 0;
+}
 
-    x = (MKL_INT *) mkl_malloc(sizeof(MKL_INT) * sample_size, 64);
-    err =
-        viRngUniform(VSL_RNG_METHOD_UNIFORM_STD, stream, sample_size, x, a, b);
-    if (err != VSL_STATUS_OK) {
-        printf("RandInt RNG error code: %d\n", err);
-    }
-    mkl_free(x);
+/* first variate of thread t; leapfrog blocks have the same lengths */
+static long part_begin(long n, int threads, int t) {
+    long rem = n % threads;
+    return n / threads * t + (t < rem ? t : rem);
 }
 
-/* mkl_random.poisson(7.2) */
-extern void sample_poisson(VSLStreamStatePtr stream, MKL_INT sample_size) {
-    MKL_INT *x;
+/* whether MKL implements method for brng on threads threads */
+static int supports(MKL_INT brng, enum method m, int threads) {
+    VSLStreamStatePtr stream;
     int err;
-    double rate = 7.2;
 
-    x = (MKL_INT *) mkl_malloc(sizeof(MKL_INT) * sample_size, 64);
-    err = viRngPoisson(VSL_RNG_METHOD_POISSON_POISNORM, stream, sample_size, x,
-                       rate);
-    if (err != VSL_STATUS_OK) {
-        printf("Poisson RNG error code: %d\n", err);
-    }
-    mkl_free(x);
+    if (m == FAMILY)
+        return threads <= family_size(brng);
+    if (vslNewStream(&stream, brng, 123) != VSL_STATUS_OK)
+        return 0;
+    if (m == SKIPAHEAD)
+        err = vslSkipAheadStream(stream, 1);
+    else
+        err = vslLeapfrogStream(stream, 0, threads);
+    vslDeleteStream(&stream);
+    return err == VSL_STATUS_OK;
 }
 
-/* mkl_random.hypergeometric(n_good=214, n_bad=97, n_sample=83) */
-extern void sample_hypergeom(VSLStreamStatePtr stream, MKL_INT sample_size) {
-    MKL_INT *x;
-    int err;
-    MKL_INT el = 214 + 97, es = 83, em = 214;
+/* n variates into out, partitioned over threads threads by method, or
+ * drawn by the calling thread from one stream if threads is 0. Returns 0,
+ * or the first failed VSL status, or -1 if fewer threads ran. */
+static int fill(MKL_INT brng, enum method m, DistributionSampler sampling_fn,
+                size_t elem_size, long n, int threads, char *out) {
+    int status = VSL_STATUS_OK;
+
+    if (!threads) {
+        VSLStreamStatePtr stream;
+        status = vslNewStream(&stream, brng, 123);
+        if (status != VSL_STATUS_OK)
+            return status;
+        status = (*sampling_fn)(stream, n, out);
+        vslDeleteStream(&stream);
+        return status;
+    }
+#pragma omp parallel num_threads(threads)
+    {
+        int t = omp_get_thread_num();
+        long begin = part_begin(n, threads, t);
+        long end = part_begin(n, threads, t + 1);
+        VSLStreamStatePtr stream;
+        int err = -1;
+
+        if (omp_get_num_threads() == threads)
+            err = vslNewStream(&stream, m == FAMILY ? brng + t : brng, 123);
+        if (err == VSL_STATUS_OK) {
+            if (m == SKIPAHEAD)
+                err = vslSkipAheadStream(stream, begin);
+            else if (m == LEAPFROG)
+                err = vslLeapfrogStream(stream, t, threads);
+            if (err == VSL_STATUS_OK)
+                err = (*sampling_fn)(stream, end - begin,
+                                     out + begin * elem_size);
+            vslDeleteStream(&stream);
+        }
+        if (err != VSL_STATUS_OK) {
+#pragma omp critical
+            if (status == VSL_STATUS_OK)
+                status = err;
+        }
+    }
+    return status;
+}
 
-    x = (MKL_INT *) mkl_malloc(sizeof(MKL_INT) * sample_size, 64);
-    err = viRngHypergeometric(VSL_RNG_METHOD_HYPERGEOMETRIC_H2PE, stream,
-                              sample_size, x, el, es, em);
-    if (err != VSL_STATUS_OK) {
-        printf("RandInt RNG error code: %d\n", err);
+/* whether out holds the variates of the serial ref, leapfrog blocks
+ * read back through the interleaving */
+static int matches_serial(enum method m, const char *ref, const char *out,
+                          size_t elem_size, long n, int threads) {
+    long i;
+    int t;
+
+    if (m != LEAPFROG)
+        return !memcmp(ref, out, n * elem_size);
+    for (t = 0; t < threads; t++) {
+        long begin = part_begin(n, threads, t);
+        long end = part_begin(n, threads, t + 1);
+        for (i = begin; i < end; i++)
+            if (memcmp(out + i * elem_size,
+                       ref + (t + (i - begin) * threads) * elem_size,
+                       elem_size))
+                return 0;
     }
+    return 1;
+}
 
-    mkl_free(x);
+/* fastest of OUTER_REPS fills, stream creation included, in seconds, or
+ * -1 with the failed status in *status */
+static double time_fill(MKL_INT brng, enum method m,
+                        DistributionSampler sampling_fn, size_t elem_size,
+                        long n, int threads, char *out, int *status) {
+    double min_time = 1e30;
+    int outer_it;
+
+    for (outer_it = 0; outer_it < OUTER_REPS; outer_it++) {
+        timer_ticks t_start = timer_start();
+        double t;
+        *status = fill(brng, m, sampling_fn, elem_size, n, threads, out);
+        t = timer_seconds(t_start, timer_stop());
+        if (*status != VSL_STATUS_OK)
+            return -1.0;
+        if (t < min_time)
+            min_time = t;
+    }
+    return min_time;
 }
 
-#define BRNGS_LEN 9
-const MKL_INT brngs[BRNGS_LEN] = {
-    VSL_BRNG_WH,     VSL_BRNG_MT19937,  VSL_BRNG_SFMT19937,
-    VSL_BRNG_MT2203, VSL_BRNG_R250,     VSL_BRNG_MCG31,
-    VSL_BRNG_MCG59,  VSL_BRNG_MRG32K3A, VSL_BRNG_PHILOX4X32X10};
-const char *brng_names[BRNGS_LEN] = {"WH",     "MT19937",  "SFMT19937",
-                                     "MT2203", "R250",     "MCG31",
-                                     "MCG59",  "MRG32K3A", "PHILOX4X32X10"};
-
-typedef void (*DistributionSampler)(VSLStreamStatePtr stream,
-                                    MKL_INT sample_size);
-
-#define FN_LEN 7
-const DistributionSampler fns[FN_LEN] = {
-    &sample_uniform, &sample_normal,  &sample_gamma,    &sample_beta,
-    &sample_randint, &sample_poisson, &sample_hypergeom};
-
-const char *dist_names[FN_LEN] = {"uniform", "normal",  "gamma",    "beta",
-                                  "randint", "poisson", "hypergeom"};
-
-const MKL_INT dist_sample_sizes[FN_LEN] = {
-    10 * SAMPLE_SIZE,                                             /* uniform */
-    2 * SAMPLE_SIZE,  SAMPLE_SIZE, SAMPLE_SIZE, 10 * SAMPLE_SIZE, /* randint */
-    5 * SAMPLE_SIZE,                                              /* poisson */
-    SAMPLE_SIZE};
-
-int main(void) {
-    VSLStreamStatePtr stream;
-    int err, outer_it, inner_it, brng_idx, fn_idx;
-    double times[OUTER_REPS];
+/*
+ * Every BRNG, distribution and method on threads threads against one
+ * stream on one thread. Efficiency is the serial time over threads times
+ * the parallel time; Serial tells whether the parallel array equals the
+ * serial one.
+ */
+static void parallel_bench(int threads, long n) {
+    size_t size = n * sizeof(double);
+    char *ref = mkl_malloc(size, 64);
+    char *out = mkl_malloc(size, 64);
+    int brng_idx, fn_idx, m, status;
+
+    if (!ref || !out) {
+        fprintf(stderr, "error: cannot allocate 2 x %zu bytes\n", size);
+        if (ref)
+            mkl_free(ref);
+        if (out)
+            mkl_free(out);
+        exit(EXIT_FAILURE);
+    }
+
+    /* prefaulted by the threads that will write them */
+#pragma omp parallel num_threads(threads)
+    {
+        int t = omp_get_thread_num();
+        long begin = part_begin(size, threads, t);
+        long end = part_begin(size, threads, t + 1);
+        memset(ref + begin, 0, end - begin);
+        memset(out + begin, 0, end - begin);
+    }
 
+    printf("Prefix,Threads,Size,BRNG,Distribution,Method,Time:serial,Time,"
+           "Speedup,Efficiency,Serial\n");
     for (brng_idx = 0; brng_idx < BRNGS_LEN; brng_idx++) {
+        MKL_INT brng = brngs[brng_idx];
         for (fn_idx = 0; fn_idx < FN_LEN; fn_idx++) {
             DistributionSampler sampling_fn = fns[fn_idx];
-            MKL_INT sz = dist_sample_sizes[fn_idx];
+            size_t elem_size = dist_elem_sizes[fn_idx];
+            double serial_time = time_fill(brng, SKIPAHEAD, sampling_fn,
+                                           elem_size, n, 0, ref, &status);
+
+            if (serial_time < 0.0) {
+                printf("# %s %s: serial fill failed with status %d\n",
+                       brng_names[brng_idx], dist_names[fn_idx], status);
+                continue;
+            }
 
-            for (outer_it = 0; outer_it < OUTER_REPS; outer_it++) {
-                struct timespec ts_start, ts_finish;
+            for (m = 0; m < N_METHODS; m++) {
+                double time;
+                const char *serial;
 
-                err = vslNewStream(&stream, brngs[brng_idx], 123);
-                if (err != VSL_STATUS_OK) {
-                    printf("PANIC: abandon ship... \n");
+                printf("Native-C,%d,%ld,%s,%s,%s,%.5f,", threads, n,
+                       brng_names[brng_idx], dist_names[fn_idx],
+                       method_names[m], serial_time);
+                if (!supports(brng, m, threads)) {
+                    printf("nan,nan,nan,unsupported\n");
+                    continue;
                 }
-
-                clock_gettime(CLOCK_MONOTONIC, &ts_start);
-                for (inner_it = 0; inner_it < INNER_REPS; inner_it++) {
-                    (*sampling_fn)(stream, sz);
+                time = time_fill(brng, m, sampling_fn, elem_size, n,
+                                 threads, out, &status);
+                /* e.g. a skip-ahead too long for the BRNG */
+                if (time < 0.0) {
+                    printf("nan,nan,nan,unsupported\n");
+                    printf("# %s %s on %d threads: status %d\n",
+                           brng_names[brng_idx], method_names[m], threads,
+                           status);
+                    continue;
                 }
-                clock_gettime(CLOCK_MONOTONIC, &ts_finish);
+                if (m == FAMILY)
+                    serial = "-";
+                else if (matches_serial(m, ref, out, elem_size, n, threads))
+                    serial = "identical";
+                else
+                    serial = "different";
+                printf("%.5f,%.2f,%.2f,%s\n", time, serial_time / time,
+                       serial_time / (threads * time), serial);
+            }
+        }
+    }
+
+    mkl_free(ref);
+    mkl_free(out);
+}
+
+/* arg as an integer in [1, max], or 0 */
+static long parse_positive(const char *arg, long max) {
+    char *end;
+    long v = strtol(arg, &end, 10);
+    if (*arg == '\0' || *end != '\0' || v < 1 || v > max)
+        return 0;
+    return v;
+}
+
+static void print_usage(const char *exe) {
+    printf("usage: %s [-h] [-b] [-t THREADS [-n SIZE]]\n\n", exe);
+    printf("Times INNER_REPS=%d calls of every distribution on every BRNG "
+           "and prints\nthe fastest of %d.\n\n",
+           INNER_REPS, OUTER_REPS);
+    printf("  -b, --buffers  also time the samplers into one prefaulted\n"
+           "                 buffer per distribution, without their\n"
+           "                 allocation, and vslNewStream on its own\n");
+    printf("  -t, --threads  instead fill one array of SIZE variates on\n"
+           "                 THREADS threads with skip-ahead, leapfrog and\n"
+           "                 BRNG family streams, against one stream\n");
+    printf("  -n, --size     variates per array of --threads, default "
+           "%ld\n",
+           PARALLEL_SIZE);
+}
 
-                times[outer_it] =
-                    (ts_finish.tv_sec - ts_start.tv_sec) +
-                    (ts_finish.tv_nsec - ts_start.tv_nsec) * (1e-9);
-                vslDeleteStream(&stream);
+int main(int argc, char *argv[]) {
+    static const struct option longopts[] = {
+        {"buffers", no_argument, NULL, 'b'},
+        {"help", no_argument, NULL, 'h'},
+        {"threads", required_argument, NULL, 't'},
+        {"size", required_argument, NULL, 'n'},
+        {NULL, 0, NULL, 0}};
+    void *buffers[FN_LEN] = {NULL};
+    int brng_idx, fn_idx, opt;
+    int use_buffers = 0, threads = 0;
+    long parallel_size = PARALLEL_SIZE;
+    /* the samplers count variates in MKL_INT, 32 bits under LP64 MKL */
+    const long max_size = sizeof(MKL_INT) < sizeof(long) ? INT_MAX : LONG_MAX;
+
+    while ((opt = getopt_long(argc, argv, "bht:n:", longopts, NULL)) != -1) {
+        switch (opt) {
+        case 'b':
+            use_buffers = 1;
+            break;
+        case 't':
+            threads = (int) parse_positive(optarg, INT_MAX);
+            if (threads < 1) {
+                fprintf(stderr, "error: bad thread count '%s'\n", optarg);
+                print_usage(argv[0]);
+                return 1;
             }
+            break;
+        case 'n':
+            parallel_size = parse_positive(optarg, max_size);
+            if (parallel_size < 1) {
+                fprintf(stderr,
+                        "error: bad size '%s', need 1 to %ld variates\n",
+                        optarg, max_size);
+                print_usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'h':
+            print_usage(argv[0]);
+            return 0;
+        default:
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    timer_calibrate();
 
-            {
-                double min_time = times[0];
-                int i;
-                for (i = 1; i < OUTER_REPS; i++)
-                    if (times[i] < min_time)
-                        min_time = times[i];
+    if (threads) {
+        if (parallel_size < threads) {
+            fprintf(stderr, "error: fewer variates than threads\n");
+            return 1;
+        }
+        parallel_bench(threads, parallel_size);
+        return 0;
+    }
+
+    if (use_buffers) {
+        /* written once, so that no timed call takes a page fault */
+        for (fn_idx = 0; fn_idx < FN_LEN; fn_idx++) {
+            size_t size = dist_sample_sizes[fn_idx] * dist_elem_sizes[fn_idx];
+            buffers[fn_idx] = mkl_malloc(size, 64);
+            memset(buffers[fn_idx], 0, size);
+        }
+        printf("Prefix,Size,BRNG,Distribution,Time,Time:alloc,Stream:us,"
+               "ns/variate,ns/variate:alloc,GB/s,GB/s:alloc\n");
+    } else {
+        printf("Prefix,Size,BRNG,Distribution,Time\n");
+    }
 
-                printf("Native-C,%d,%s,%s,%.5f\n", sz,  brng_names[brng_idx],
-                       dist_names[fn_idx], min_time);
+    for (brng_idx = 0; brng_idx < BRNGS_LEN; brng_idx++) {
+        for (fn_idx = 0; fn_idx < FN_LEN; fn_idx++) {
+            DistributionSampler sampling_fn = fns[fn_idx];
+            MKL_INT sz = dist_sample_sizes[fn_idx];
+            double stream_time = 1e30;
+            double alloc_time, buffer_time, variates, nbytes;
+
+            alloc_time = time_sampler(brngs[brng_idx], sampling_fn, sz, NULL,
+                                      &stream_time);
+            if (!use_buffers) {
+                printf("Native-C,%d,%s,%s,%.5f\n", sz, brng_names[brng_idx],
+                       dist_names[fn_idx], alloc_time);
+                continue;
             }
+
+            buffer_time = time_sampler(brngs[brng_idx], sampling_fn, sz,
+                                       buffers[fn_idx], &stream_time);
+            variates = (double) sz * INNER_REPS;
+            nbytes = variates * dist_elem_sizes[fn_idx];
+            printf("Native-C,%d,%s,%s,%.5f,%.5f,%.3f,%.3f,%.3f,%.2f,%.2f\n",
+                   sz, brng_names[brng_idx], dist_names[fn_idx], buffer_time,
+                   alloc_time, stream_time * 1e6, buffer_time * 1e9 / variates,
+                   alloc_time * 1e9 / variates, nbytes / buffer_time * 1e-9,
+                   nbytes / alloc_time * 1e-9);
         }
     }
 
+    for (fn_idx = 0; fn_idx < FN_LEN; fn_idx++)
+        if (buffers[fn_idx])
+            mkl_free(buffers[fn_idx]);
+
     return 0;
 }
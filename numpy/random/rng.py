@@ -5,6 +5,7 @@
 import numpy as np
 import timeit
 import sys
+import os
 
 def sample_uniform(rs, sz):
     rs.uniform(-1, 1, size=sz)
@@ -48,10 +49,11 @@ def main():
     import argparse
     parser = argparse.ArgumentParser()
     parser.add_argument('--prefix',  required=False, default="IntelPython",     help="Print with each result")
-    parser.add_argument('--impl',  required=False, default="mkl_random", choices=['mkl_random', 'numpy'], help='RNG implementation\n'
+    parser.add_argument('--impl',  required=False, default="mkl_random", choices=['mkl_random', 'numpy', 'native'], help='RNG implementation\n'
                                                                  'choices:\n'
                                                                  'mkl_random: mkl_random.RandomState to be used\n'
-                                                                 'numpy: numpy.Generator to be used')
+                                                                 'numpy: numpy.Generator to be used\n'
+                                                                 'native: the samplers of rng.c in librng_native.so (make native), timed in C')
 
     args = parser.parse_args()
 
@@ -63,6 +65,18 @@ def main():
             print(str(e))
             print('mkl_random is chosen for benchmark, however it is not found in current environemnt')
             sys.exit(1)
+    elif args.impl == 'native':
+        import ctypes
+        try:
+            native = ctypes.CDLL(os.path.join(os.path.dirname(os.path.abspath(__file__)), 'librng_native.so'))
+        except OSError as e:
+            print(str(e))
+            print("build it with 'make -C numpy/random native'")
+            sys.exit(1)
+        native.run_kernel.restype = ctypes.c_double
+        native.run_kernel.argtypes = [ctypes.c_char_p, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_long, ctypes.c_long]
+        native.native_ghz.restype = ctypes.c_double
+        mkl = True
     else:
         import numpy.random as rnd
         mkl = False
@@ -76,10 +90,21 @@ def main():
                 'randint': sample_randint, 'poisson': sample_poisson, 'hypergeom': sample_hypergeom}
     multipliers = {'uniform': 10, 'normal': 2, 'gamma': 1, 'beta': 1, 'randint': 10, 'poisson': 5, 'hypergeom': 1}
 
+    print("Prefix,Size,BRNG,Distribution,Time")
     for brng_name, sfn in itertools.product(brngs, samplers.keys()):
         func = samplers[sfn]
         m = multipliers[sfn]
         times_list = []
+        if args.impl == 'native':
+            # out=None: every call allocates and frees its own output, as the
+            # Python samplers below do, so the gap to their rows is dispatch
+            # overhead and not allocation or page faults; the stream is
+            # created outside the timed calls, like the RandomState below
+            for __ in range(OUTER_REPS):
+                ticks = native.run_kernel(f"{brng_name}/{sfn}".encode(), None, None, None, m*100*1000, INNER_REPS)
+                times_list.append(ticks / (native.native_ghz() * 1e9))
+            print(f"{args.prefix},{m*100*1000},{brng_name},{sfn},{min(times_list):.5f}")
+            continue
         for __ in range(OUTER_REPS):
             if mkl:
                 rs = rnd.RandomState(SEED, brng=brng_name)
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * The samplers of rng.py's distributions and the BRNGs they run on, shared
+ * by the rng bench and librng_native.so.
+ */
+
+#ifndef __RNG_KERNELS_H
+#define __RNG_KERNELS_H
+
+#include "mkl.h"
+#include <stddef.h>
+
+#define SAMPLE_SIZE 100000
+
+/* draws sample_size variates into out, or into a buffer allocated and
+ * freed by every call if out is NULL, and returns the VSL status */
+typedef int (*DistributionSampler)(VSLStreamStatePtr stream,
+                                   MKL_INT sample_size, void *out);
+
+int sample_uniform(VSLStreamStatePtr stream, MKL_INT sample_size, void *out);
+int sample_normal(VSLStreamStatePtr stream, MKL_INT sample_size, void *out);
+int sample_gamma(VSLStreamStatePtr stream, MKL_INT sample_size, void *out);
+int sample_beta(VSLStreamStatePtr stream, MKL_INT sample_size, void *out);
+/* randint, poisson and hypergeom draw MKL_INT */
+int sample_randint(VSLStreamStatePtr stream, MKL_INT sample_size, void *out);
+int sample_poisson(VSLStreamStatePtr stream, MKL_INT sample_size, void *out);
+int sample_hypergeom(VSLStreamStatePtr stream, MKL_INT sample_size,
+                     void *out);
+
+#define BRNGS_LEN 9
+extern const MKL_INT brngs[BRNGS_LEN];
+extern const char *brng_names[BRNGS_LEN];
+
+#define FN_LEN 7
+extern const DistributionSampler fns[FN_LEN];
+extern const char *dist_names[FN_LEN];
+extern const MKL_INT dist_sample_sizes[FN_LEN];
+/* bytes per variate: sizeof(double) or sizeof(MKL_INT) */
+extern const size_t dist_elem_sizes[FN_LEN];
+
+#endif /* __RNG_KERNELS_H */
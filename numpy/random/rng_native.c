@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * librng_native.so: the samplers of rng_kernels.h behind the ABI of
+ * native.h. Names read "BRNG/distribution" with the names of brng_names and
+ * dist_names, e.g. "MT19937/normal". A stream seeded with 123, as rng.py
+ * seeds its own, is created before and deleted after the timed calls,
+ * each of which draws n variates into out; x and y are unused. out holds
+ * n doubles, which leaves room for the MKL_INT distributions, or is NULL
+ * to have every call allocate and free its output like numpy does.
+ */
+
+#include "native.h"
+#include "rng_kernels.h"
+#include "timer.h"
+#include <string.h>
+
+#define SEED 123
+
+double native_ghz(void) {
+    return timer_calibrate()->ghz;
+}
+
+double run_kernel(const char *name, const double *x, const double *y,
+                  double *out, long n, long reps) {
+    const char *slash = strchr(name, '/');
+    VSLStreamStatePtr stream;
+    timer_ticks t0, t1;
+    int b, f;
+    long j;
+
+    if (!slash)
+        return -1.0;
+    for (b = 0; b < BRNGS_LEN; b++)
+        if (strlen(brng_names[b]) == (size_t) (slash - name) &&
+            !strncmp(name, brng_names[b], slash - name))
+            break;
+    for (f = 0; f < FN_LEN; f++)
+        if (!strcmp(slash + 1, dist_names[f]))
+            break;
+    if (b == BRNGS_LEN || f == FN_LEN)
+        return -1.0;
+
+    timer_calibrate();
+    if (vslNewStream(&stream, brngs[b], SEED) != VSL_STATUS_OK)
+        return -1.0;
+    t0 = timer_start();
+    for (j = 0; j < reps; j++)
+        fns[f](stream, n, out);
+    t1 = timer_stop();
+    vslDeleteStream(&stream);
+    return timer_elapsed(t0, t1);
+}
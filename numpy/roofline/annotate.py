@@ -0,0 +1,329 @@
+# Copyright (C) 2019 Intel Corporation
+#
+# SPDX-License-Identifier: MIT
+
+"""Place benchmark results on the roofline measured by ./roofline.
+
+Reads result CSV lines of the linalg, umath (native and Python), reduction,
+copy and rng benches, and appends the arithmetic intensity, the achieved
+GFLOP/s and GB/s, the attainable GFLOP/s at that intensity, the fraction of it
+achieved and whether the kernel is bandwidth- or compute-bound. Rows are read
+by the most recent CSV header line, which the umath benches print with
+--header. Rows under any other header, or under none, are passed through
+unchanged.
+
+Flop counts of LAPACK routines are the usual leading terms. Transcendental
+functions and random variates are charged rough operation counts of
+typical polynomial implementations. Bytes are compulsory traffic: every
+input read once and every output written once. Treat the intensities of
+blocked factorizations as upper bounds.
+"""
+
+import argparse
+import csv
+import sys
+
+# flops per element, bytes per element (8-byte reads + writes)
+UMATH_BINARY_FLOPS = 1
+UMATH_UNARY = {
+    'copyto': 0, 'sqrt': 1, 'invsqrt': 2,
+    'exp': 15, 'exp2': 15, 'expm1': 18,
+    'log': 20, 'log2': 21, 'log10': 21, 'log1p': 22,
+    'sin': 20, 'cos': 20, 'tan': 30,
+    'sinh': 20, 'cosh': 20, 'tanh': 25,
+    'arcsin': 30, 'arccos': 30, 'arctan': 25,
+    'arcsinh': 30, 'arccosh': 30, 'arctanh': 30,
+    'erf': 30,
+}
+
+# reductions: flops per element, bytes per element
+REDUCE = {
+    'sum': (1, 8), 'mean': (1, 8), 'dot': (2, 16), 'norm': (2, 8),
+    'min': (1, 8), 'max': (1, 8), 'argmax': (1, 8),
+}
+
+# flops per variate, bytes per variate
+RNG = {
+    'uniform': (2, 8), 'normal': (30, 8), 'gamma': (40, 8), 'beta': (60, 8),
+    'randint': (4, 4), 'poisson': (30, 4), 'hypergeom': (60, 4),
+}
+RNG_INNER_REPS = 512
+
+
+def multi_dot_dims(chain, n):
+    """Shape chain of MultiDot::chain_dims() in multi_dot.cc"""
+    def part(d):
+        return max(n // d, 1)
+    return {
+        'docs': [n, part(10), n, part(200), part(3)],
+        'tall': [n, part(50), n, part(50)],
+        'gram': [part(10), n, part(10), n, 1],
+        'ltr': [part(16), part(8), part(4), part(2), n],
+    }.get(chain)
+
+
+def multi_dot_cost(p, optimal):
+    """Scalar multiplications and elements of a multi_dot chain"""
+    k = len(p) - 1
+    cost = [[0] * k for _ in range(k)]
+    for l in range(1, k):
+        for i in range(k - l):
+            j = i + l
+            if optimal:
+                cost[i][j] = min(cost[i][s] + cost[s + 1][j] +
+                                 p[i] * p[s + 1] * p[j + 1]
+                                 for s in range(i, j))
+            else:
+                cost[i][j] = cost[i][j - 1] + p[i] * p[j] * p[j + 1]
+    return cost[0][k - 1], sum(p[i] * p[i + 1] for i in range(k)) + p[0] * p[k]
+
+
+def linalg_model(func, n):
+    """(flops, bytes) of one call of a linalg bench of size n"""
+    n = float(n)
+    sq = 8 * n * n
+    models = {
+        'dot': (2 * n ** 3, 3 * sq),
+        'gemv': (2 * n * n, sq + 16 * n),
+        'syrk': (n ** 3, 2 * sq),
+        'syr2k': (2 * n ** 3, 3 * sq),
+        'cholesky': (n ** 3 / 3, 2 * sq),
+        'det': (2 * n ** 3 / 3, sq),
+        'lu': (2 * n ** 3 / 3, 4 * sq),
+        'inv': (2 * n ** 3, 2 * sq),
+        'qr': (4 * n ** 3 / 3, 3 * sq),
+        'eig': (25 * n ** 3, 3 * sq),
+        'svd': (21 * n ** 3, 4 * sq),
+        'ooc_gemm': (2 * n ** 3, 3 * sq),
+        'ooc_cholesky': (n ** 3 / 3, 2 * sq),
+    }
+    if func.startswith('multi_dot'):
+        # multi_dot[_CHAIN][_naive]
+        parts = func.split('_')[2:]
+        optimal = parts[-1:] != ['naive']
+        if not optimal:
+            parts = parts[:-1]
+        dims = multi_dot_dims(parts[0] if parts else 'docs', int(n))
+        if not dims:
+            return None
+        mults, elems = multi_dot_cost(dims, optimal)
+        return 2.0 * mults, 8.0 * elems
+    return models.get(func)
+
+
+def umath_model(func):
+    """(flops, bytes) per element of a umath function"""
+    func = func.strip()
+    if func in UMATH_UNARY:
+        return UMATH_UNARY[func], 16
+    if func.startswith('array') and func.endswith('array'):
+        return UMATH_BINARY_FLOPS, 24
+    if 'scalar' in func:
+        return UMATH_BINARY_FLOPS, 16
+    return None
+
+
+# bytes per element of the umath Type column, the models count float64
+ITEMSIZE = {'float64': 8, 'float32': 4, 'complex64': 8, 'complex128': 16}
+
+
+def strided_bytes(stride, contiguous):
+    """bytes per element of a unary function on x[::stride] or x[idx]"""
+    if stride == 'gather':
+        return 24
+    stride = int(stride)
+    if stride == 1:
+        return contiguous
+    return 8 * min(stride, 8) + 8
+
+
+class Roofline:
+    def __init__(self, peaks_file):
+        self.bw = {}
+        self.peak = {}
+        self.capacity = {}
+        self.tsc_ghz = None
+        with open(peaks_file) as f:
+            for row in csv.DictReader(f):
+                threads = int(row['Threads'])
+                value = float(row['Value'])
+                if row['Kernel'] == 'tsc':
+                    self.tsc_ghz = value
+                elif row['Kernel'] == 'triad':
+                    self.bw[(row['Level'], threads)] = value
+                    self.capacity[row['Level']] = int(row['Bytes'])
+                elif row['Kernel'] == 'fma':
+                    self.peak[threads] = value
+        self.threads = sorted(self.peak)
+
+    def pick_threads(self, single):
+        return self.threads[0] if single else self.threads[-1]
+
+    def level(self, footprint):
+        for lvl in ('L2', 'LLC'):
+            cap = self.capacity.get(lvl, 0)
+            if footprint <= cap:
+                return lvl
+        return 'DRAM'
+
+    def annotate(self, flops, nbytes, seconds, footprint, single):
+        threads = self.pick_threads(single)
+        lvl = self.level(footprint)
+        bw = self.bw[(lvl, threads)]
+        peak = self.peak[threads]
+        gflops = flops / seconds * 1e-9
+        gbs = nbytes / seconds * 1e-9
+        ai = flops / nbytes if nbytes else float('inf')
+        roof = min(peak, ai * bw)
+        bound = 'bandwidth' if ai * bw < peak else 'compute'
+        # kernels without flops, copies, are held against the bandwidth
+        frac = gflops / roof if flops else gbs / bw
+        return ['%.4g' % ai, '%.4g' % gflops, '%.4g' % gbs, lvl,
+                '%.4g' % roof, '%.1f%%' % (100 * frac), bound]
+
+
+EXTRA = ['AI', 'GFLOP/s', 'GB/s', 'Level', 'Roof:GFLOP/s', 'Roof:%', 'Bound']
+
+
+def cpe_seconds(row, roof, n):
+    """seconds of n elements at the row's CPE in TSC ticks"""
+    return float(row['CPE']) * n / (roof.tsc_ghz * 1e9)
+
+
+def annotate_linalg(row, roof, args):
+    model = linalg_model(row['Function'], int(row['Size']))
+    if not model:
+        return None
+    flops, nbytes = model
+    return roof.annotate(flops, nbytes, float(row['Time']), nbytes,
+                         single=False)
+
+
+def annotate_rng(row, roof, args):
+    # Time is that of RNG_INNER_REPS calls of Size variates each
+    if row['Distribution'] not in RNG:
+        return None
+    flops, width = RNG[row['Distribution']]
+    size = float(row['Size'])
+    count = size * RNG_INNER_REPS
+    return roof.annotate(flops * count, width * count, float(row['Time']),
+                         width * size, single=True)
+
+
+def annotate_reduce(row, roof, args):
+    if row['Function'] not in REDUCE:
+        return None
+    flops, width = REDUCE[row['Function']]
+    n = float(row['Size'])
+    return roof.annotate(flops * n, width * n, cpe_seconds(row, roof, n),
+                         width * n, single=row['Threads'] == '1')
+
+
+def annotate_copy(row, roof, args):
+    n = float(row['Size'])
+    return roof.annotate(0, 16 * n, cpe_seconds(row, roof, n), 16 * n,
+                         single=row['Threads'] == '1')
+
+
+def annotate_umath_native(row, roof, args):
+    model = umath_model(row['Function'])
+    if not model:
+        return None
+    n = float(row['Size'])
+    nbytes = strided_bytes(row['Stride'], model[1])
+    nbytes = nbytes * ITEMSIZE.get(row['Type'], 8) // 8
+    return roof.annotate(model[0] * n, nbytes * n, cpe_seconds(row, roof, n),
+                         nbytes * n, single=row['Threads'] == '1')
+
+
+def annotate_umath_python(row, roof, args):
+    # also what the native bench prints with --offsets
+    model = umath_model(row['Function'])
+    if not model:
+        return None
+    n = float(row['Size'])
+    nbytes = model[1] * ITEMSIZE.get(row['Type'], 8) // 8
+    ghz = args.python_clock_ghz or roof.tsc_ghz
+    seconds = float(row['CPE:aligned']) * n / (ghz * 1e9)
+    return roof.annotate(model[0] * n, nbytes * n, seconds, nbytes * n,
+                         single=False)
+
+
+# The header lines of the benches, and how to annotate the rows below them.
+# Rows are read by column name, so a bench that adds a column must add its
+# new header here.
+SCHEMAS = {
+    ('Prefix', 'Function', 'Size', 'Time'): annotate_linalg,
+    # rng.c and rng.py, and rng.c --buffers
+    ('Prefix', 'Size', 'BRNG', 'Distribution', 'Time'): annotate_rng,
+    ('Prefix', 'Size', 'BRNG', 'Distribution', 'Time', 'Time:alloc',
+     'Stream:us', 'ns/variate', 'ns/variate:alloc', 'GB/s',
+     'GB/s:alloc'): annotate_rng,
+    ('Prefix', 'Implementation', 'Function', 'Size', 'CPE', 'GB/s',
+     'Threads', 'Error'): annotate_reduce,
+    ('Prefix', 'Implementation', 'Function', 'Size', 'CPE', 'GB/s',
+     'Threads', 'Offset:src', 'Offset:dst'): annotate_copy,
+    ('Prefix', 'Implementation', 'Function', 'Size', 'CPE', 'GB/s', 'Level',
+     'Threads', 'Stride', 'Type', 'ULP:max', 'ULP:mean',
+     'Input'): annotate_umath_native,
+    ('Prefix', 'Implementation', 'Function', 'Type', 'Iterations', 'Size',
+     'CPE:aligned', 'CPE:max', 'Input'): annotate_umath_python,
+}
+
+
+class Annotator:
+    """Annotates the rows below the most recent header line of a file"""
+
+    def __init__(self, roof, args):
+        self.roof = roof
+        self.args = args
+        self.header = None
+
+    def line(self, line):
+        line = line.rstrip('\n')
+        if not line.strip() or line.startswith('#') or line.startswith('@ '):
+            return line
+        fields = tuple(f.strip() for f in line.split(','))
+
+        # a header line of any bench starts a new table, known or not
+        if fields[0] == 'Prefix':
+            self.header = fields if fields in SCHEMAS else None
+            return line + ',' + ','.join(EXTRA) if self.header else line
+
+        if not self.header or len(fields) != len(self.header):
+            return line
+        try:
+            ann = SCHEMAS[self.header](dict(zip(self.header, fields)),
+                                       self.roof, self.args)
+        except ValueError:
+            # e.g. an n/a cell
+            ann = None
+        if ann is None:
+            return line
+        return line + ',' + ','.join(ann)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--peaks', default='peaks.csv',
+                        help='output of ./roofline (default: %(default)s)')
+    parser.add_argument('--python-clock-ghz', type=float, default=None,
+                        help='ticks per ns of the clock used by '
+                             'umath_mem_bench.py; defaults to the TSC '
+                             'frequency, use 2 for its default_timer fallback')
+    parser.add_argument('results', nargs='*',
+                        help='result files, standard input if none')
+    args = parser.parse_args()
+
+    roof = Roofline(args.peaks)
+    files = [open(r) for r in args.results] if args.results else [sys.stdin]
+    for f in files:
+        annotator = Annotator(roof, args)
+        for line in f:
+            print(annotator.line(line))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Machine ceilings for roofline plots: sustained triad bandwidth with the
+ * working set in L2, in the last level cache and in DRAM, and peak
+ * double precision FMA throughput, each for one core and for all OpenMP
+ * threads. Pin the threads to one socket (OMP_PLACES, numactl) to get
+ * per-socket numbers.
+ */
+
+#include "timer.h"
+#include <getopt.h>
+#include <limits.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DEFAULT_PREFIX "Native-C"
+#define DEFAULT_REPS 10
+#define DEFAULT_L2 (1L << 20)
+#define DEFAULT_LLC (32L << 20)
+#define MIN_DRAM (256L << 20)
+
+/* seconds a single measurement should take at least */
+#define MIN_TIME 0.01
+
+#define FMA_CHAINS 16
+#define FMA_ITERS 100000
+
+typedef double vec8 __attribute__((vector_size(64)));
+
+static long cache_size(int name, long fallback) {
+    long sz = sysconf(name);
+    return sz > 0 ? sz : fallback;
+}
+
+/* a = b + s * c over n elements, best of reps, in GB/s */
+static double triad(long n, int threads, int reps) {
+    double *a = (double *) aligned_alloc(64, n * sizeof(double));
+    double *b = (double *) aligned_alloc(64, n * sizeof(double));
+    double *c = (double *) aligned_alloc(64, n * sizeof(double));
+    const double s = 3.0;
+    double best = 0.0;
+    long i, inner = 1;
+    int r;
+
+    /* first touch from the threads that will use the pages */
+#pragma omp parallel for num_threads(threads) schedule(static)
+    for (i = 0; i < n; i++) {
+        a[i] = 0.0;
+        b[i] = 1.0;
+        c[i] = 2.0;
+    }
+
+    for (r = 0; r < reps; r++) {
+        long k;
+        timer_ticks t0 = timer_start();
+        double t;
+        for (k = 0; k < inner; k++) {
+#pragma omp parallel for num_threads(threads) schedule(static)
+            for (i = 0; i < n; i++)
+                a[i] = b[i] + s * c[i];
+        }
+        t = timer_seconds(t0, timer_stop());
+
+        /* grow the inner loop until one measurement is long enough */
+        if (t < MIN_TIME) {
+            inner *= 2;
+            r--;
+            continue;
+        }
+        t = 3.0 * sizeof(double) * n * inner / t * 1e-9;
+        if (t > best)
+            best = t;
+    }
+
+    if (a[n / 2] != b[n / 2] + s * c[n / 2])
+        fprintf(stderr, "# warning: triad result mismatch\n");
+    free(a);
+    free(b);
+    free(c);
+    return best;
+}
+
+/* FMA_CHAINS independent chains of 8-wide FMAs per thread, in GFLOP/s */
+static double fma_peak(int threads, int reps) {
+    double best = 0.0, sink = 0.0;
+    int r;
+
+    for (r = 0; r < reps; r++) {
+        timer_ticks t0 = timer_start();
+        double t;
+#pragma omp parallel num_threads(threads) reduction(+ : sink)
+        {
+            vec8 acc[FMA_CHAINS];
+            vec8 m, a;
+            long it;
+            int k, l;
+
+            for (l = 0; l < 8; l++) {
+                m[l] = 0.999999;
+                a[l] = 1e-9 * (l + omp_get_thread_num());
+            }
+            for (k = 0; k < FMA_CHAINS; k++)
+                acc[k] = a * k;
+
+            for (it = 0; it < FMA_ITERS; it++) {
+                for (k = 0; k < FMA_CHAINS; k++)
+                    acc[k] = acc[k] * m + a;
+            }
+
+            for (k = 0; k < FMA_CHAINS; k++)
+                for (l = 0; l < 8; l++)
+                    sink += acc[k][l];
+        }
+        t = timer_seconds(t0, timer_stop());
+        t = 2.0 * 8 * FMA_CHAINS * FMA_ITERS * threads / t * 1e-9;
+        if (t > best)
+            best = t;
+    }
+
+    if (sink == 42.0)
+        printf("# %g\n", sink);
+    return best;
+}
+
+static void print_row(const char *prefix, const char *kernel,
+                      const char *level, int threads, long bytes,
+                      double value, const char *unit) {
+    printf("%s,%s,%s,%d,%ld,%.4g,%s\n", prefix, kernel, level, threads,
+           bytes, value, unit);
+}
+
+void print_usage(const char *exe) {
+    printf("usage: %s [-h] [-r REPS] [-p PREFIX]\n", exe);
+}
+
+int main(int argc, char *argv[]) {
+    char *prefix = DEFAULT_PREFIX;
+    int reps = DEFAULT_REPS;
+    int all = omp_get_max_threads();
+    int t, i;
+    long l2, llc, dram;
+
+    static const struct option longopts[] = {
+        {"reps", required_argument, NULL, 'r'},
+        {"prefix", required_argument, NULL, 'p'},
+        {"help", no_argument, NULL, 'h'},
+        {0, 0, 0, 0}};
+
+    int opt;
+    int optind = 0;
+    while ((opt = getopt_long(argc, argv, "hr:p:", longopts, &optind)) !=
+           -1) {
+        switch (opt) {
+        case 'r': {
+            char *end;
+            long r = strtol(optarg, &end, 10);
+            if (*optarg == '\0' || *end != '\0' || r < 1 || r > INT_MAX) {
+                fprintf(stderr, "error: REPS must be a positive integer, "
+                                "not '%s'\n",
+                        optarg);
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            reps = (int) r;
+            break;
+        }
+        case 'p':
+            prefix = optarg;
+            break;
+        case 'h':
+            print_usage(argv[0]);
+            printf("\nMeasures bandwidth and FMA ceilings for roofline "
+                   "analysis, see annotate.py\n");
+            return EXIT_SUCCESS;
+        default:
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    l2 = cache_size(_SC_LEVEL2_CACHE_SIZE, DEFAULT_L2);
+    llc = cache_size(_SC_LEVEL3_CACHE_SIZE, DEFAULT_LLC);
+    dram = 8 * llc > MIN_DRAM ? 8 * llc : MIN_DRAM;
+
+    puts("Prefix,Kernel,Level,Threads,Bytes,Value,Unit");
+    /* ticks per nanosecond, to convert CPE numbers into time */
+    print_row(prefix, "tsc", "", 1, 0, timer_calibrate()->ghz, "GHz");
+
+    for (i = 0; i < 2; i++) {
+        t = i == 0 ? 1 : all;
+        if (i == 1 && all == 1)
+            break;
+
+        /* Half of the capacity keeps the three arrays resident. L2 is
+         * private, so every thread gets its own share. Bytes is the
+         * capacity of the level, used to place kernels on the roofline. */
+        print_row(prefix, "triad", "L2", t, l2,
+                  triad(l2 / 2 / 24 * t, t, reps), "GB/s");
+        print_row(prefix, "triad", "LLC", t, llc,
+                  triad(llc / 2 / 24, t, reps), "GB/s");
+        print_row(prefix, "triad", "DRAM", t, 0, triad(dram / 24, t, reps),
+                  "GB/s");
+        print_row(prefix, "fma", "peak", t, 0, fma_peak(t, reps), "GFLOP/s");
+    }
+
+    return 0;
+}
@@ -0,0 +1,479 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Copy benchmark: the ceiling of np.copyto and of any elementwise kernel.
+ * Copies of float64 arrays with memcpy, the compiler's loop, rep movsb,
+ * explicit SSE2/AVX2/AVX-512 loads and stores, and the same with
+ * nontemporal stores, at every pair of source and destination offsets
+ * from a cache line as umath_mem_bench.py --offsets does. Several threads
+ * copy a chunk each.
+ */
+
+#include "pool.h"
+#include "timer.h"
+#include <assert.h>
+#include <getopt.h>
+#include <immintrin.h>
+#include <omp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_INNER_LOOPS 200
+#define DEFAULT_OUTER_LOOPS 1
+#define DEFAULT_SIZE 2500000
+#define DEFAULT_MIN_SIZE 1024
+#define DEFAULT_OFFSETS "0,1,2,4"
+#define DEFAULT_PREFIX "Native-C"
+#define MAX_IMPLS 16
+#define MAX_THREAD_COUNTS 16
+#define MAX_THREADS 256
+#define MAX_OFFSETS 16
+/* in elements, as the slack umath_mem_bench.py allocates */
+#define MAX_OFFSET 16
+#define MAX_REPS (1 << 16)
+
+/* copies x[0:n] to y[0:n] */
+typedef void (*copy_kernel)(long n, const double *x, double *y);
+
+static void copy_memcpy(long n, const double *x, double *y) {
+    memcpy(y, x, n * sizeof(double));
+}
+
+/* what the compiler makes of numpy's inner loop, often a memcpy call */
+static void copy_loop(long n, const double *x, double *y) {
+    long i;
+    for (i = 0; i < n; i++)
+        y[i] = x[i];
+}
+
+/* fast strings microcode, which picks its own store strategy by size */
+static void copy_movsb(long n, const double *x, double *y) {
+    size_t bytes = n * sizeof(double);
+    __asm__ volatile("rep movsb"
+                     : "+D"(y), "+S"(x), "+c"(bytes)
+                     :
+                     : "memory");
+}
+
+/* elements of y to copy normally before y is aligned to align bytes */
+static inline long head(long n, const double *y, int align) {
+    long h = (long) ((align - (uintptr_t) y % align) % align / sizeof(double));
+    return h < n ? h : n;
+}
+
+/*
+ * Four unaligned loads and stores per iteration. The _nt variants align
+ * the destination, which streaming stores require, and leave the source
+ * unaligned.
+ */
+static void copy_sse2(long n, const double *x, double *y) {
+    long i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128d a = _mm_loadu_pd(x + i), b = _mm_loadu_pd(x + i + 2);
+        __m128d c = _mm_loadu_pd(x + i + 4), d = _mm_loadu_pd(x + i + 6);
+        _mm_storeu_pd(y + i, a);
+        _mm_storeu_pd(y + i + 2, b);
+        _mm_storeu_pd(y + i + 4, c);
+        _mm_storeu_pd(y + i + 6, d);
+    }
+    for (; i < n; i++)
+        y[i] = x[i];
+}
+
+static void copy_sse2_nt(long n, const double *x, double *y) {
+    long i = head(n, y, 16);
+    copy_loop(i, x, y);
+    for (; i + 8 <= n; i += 8) {
+        __m128d a = _mm_loadu_pd(x + i), b = _mm_loadu_pd(x + i + 2);
+        __m128d c = _mm_loadu_pd(x + i + 4), d = _mm_loadu_pd(x + i + 6);
+        _mm_stream_pd(y + i, a);
+        _mm_stream_pd(y + i + 2, b);
+        _mm_stream_pd(y + i + 4, c);
+        _mm_stream_pd(y + i + 6, d);
+    }
+    for (; i < n; i++)
+        y[i] = x[i];
+    _mm_sfence();
+}
+
+#if defined(__AVX2__)
+static void copy_avx2(long n, const double *x, double *y) {
+    long i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256d a = _mm256_loadu_pd(x + i), b = _mm256_loadu_pd(x + i + 4);
+        __m256d c = _mm256_loadu_pd(x + i + 8);
+        __m256d d = _mm256_loadu_pd(x + i + 12);
+        _mm256_storeu_pd(y + i, a);
+        _mm256_storeu_pd(y + i + 4, b);
+        _mm256_storeu_pd(y + i + 8, c);
+        _mm256_storeu_pd(y + i + 12, d);
+    }
+    for (; i < n; i++)
+        y[i] = x[i];
+}
+
+static void copy_avx2_nt(long n, const double *x, double *y) {
+    long i = head(n, y, 32);
+    copy_loop(i, x, y);
+    for (; i + 16 <= n; i += 16) {
+        __m256d a = _mm256_loadu_pd(x + i), b = _mm256_loadu_pd(x + i + 4);
+        __m256d c = _mm256_loadu_pd(x + i + 8);
+        __m256d d = _mm256_loadu_pd(x + i + 12);
+        _mm256_stream_pd(y + i, a);
+        _mm256_stream_pd(y + i + 4, b);
+        _mm256_stream_pd(y + i + 8, c);
+        _mm256_stream_pd(y + i + 12, d);
+    }
+    for (; i < n; i++)
+        y[i] = x[i];
+    _mm_sfence();
+}
+#endif
+
+#if defined(__AVX512F__)
+static void copy_avx512(long n, const double *x, double *y) {
+    long i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m512d a = _mm512_loadu_pd(x + i), b = _mm512_loadu_pd(x + i + 8);
+        __m512d c = _mm512_loadu_pd(x + i + 16);
+        __m512d d = _mm512_loadu_pd(x + i + 24);
+        _mm512_storeu_pd(y + i, a);
+        _mm512_storeu_pd(y + i + 8, b);
+        _mm512_storeu_pd(y + i + 16, c);
+        _mm512_storeu_pd(y + i + 24, d);
+    }
+    /* the tail with a masked load and store */
+    for (; i < n; i += 8) {
+        __mmask8 m = n - i >= 8 ? 0xff : (__mmask8) ((1u << (n - i)) - 1);
+        _mm512_mask_storeu_pd(y + i, m, _mm512_maskz_loadu_pd(m, x + i));
+    }
+}
+
+static void copy_avx512_nt(long n, const double *x, double *y) {
+    long i = head(n, y, 64);
+    copy_loop(i, x, y);
+    for (; i + 32 <= n; i += 32) {
+        __m512d a = _mm512_loadu_pd(x + i), b = _mm512_loadu_pd(x + i + 8);
+        __m512d c = _mm512_loadu_pd(x + i + 16);
+        __m512d d = _mm512_loadu_pd(x + i + 24);
+        _mm512_stream_pd(y + i, a);
+        _mm512_stream_pd(y + i + 8, b);
+        _mm512_stream_pd(y + i + 16, c);
+        _mm512_stream_pd(y + i + 24, d);
+    }
+    for (; i < n; i++)
+        y[i] = x[i];
+    _mm_sfence();
+}
+#endif
+
+typedef struct copy_t {
+    const char *impl;
+    copy_kernel kernel;
+} copy_t;
+
+/* the explicit ISA rows are those of the host, see HOST_FLAGS */
+static const copy_t copies[] = {
+    {"memcpy", copy_memcpy},
+    {"Loop", copy_loop},
+    {"RepMovsb", copy_movsb},
+    {"SSE2", copy_sse2},
+    {"SSE2-NT", copy_sse2_nt},
+#if defined(__AVX2__)
+    {"AVX2", copy_avx2},
+    {"AVX2-NT", copy_avx2_nt},
+#endif
+#if defined(__AVX512F__)
+    {"AVX512", copy_avx512},
+    {"AVX512-NT", copy_avx512_nt},
+#endif
+};
+
+#define N_COPIES ((int) (sizeof(copies) / sizeof(*copies)))
+
+/* x[0:n] to y[0:n] on threads threads, each copying its pool_split chunk */
+static void copy(const copy_t *c, int threads, long n, const double *x,
+                 double *y) {
+    if (threads == 1) {
+        c->kernel(n, x, y);
+        return;
+    }
+#pragma omp parallel num_threads(threads)
+    {
+        long begin, end;
+        pool_split(n, omp_get_num_threads(), omp_get_thread_num(), &begin,
+                   &end);
+        if (begin < end)
+            c->kernel(end - begin, x + begin, y + begin);
+    }
+}
+
+/* best of reps copies, in ticks per element */
+static double time_cpe(const copy_t *c, int threads, long n, long reps,
+                       const double *x, double *y) {
+    double cpe, cpe_min = 1e300;
+    timer_ticks t0, t1;
+    long j;
+
+    for (j = 0; j < reps; j++) {
+        t0 = timer_start();
+        copy(c, threads, n, x, y);
+        t1 = timer_stop();
+        cpe = timer_elapsed(t0, t1) / n;
+        if (cpe < cpe_min)
+            cpe_min = cpe;
+    }
+    return cpe_min;
+}
+
+/*
+ * Parse a comma separated list of integers in [lo, hi] into values.
+ * Returns the number of entries, or -1 after printing an error.
+ */
+static int parse_int_list(const char *arg, int lo, int hi, int max_count,
+                          int *values) {
+    char buf[256], *tok, *save;
+    int v, count = 0;
+
+    snprintf(buf, sizeof(buf), "%s", arg);
+    for (tok = strtok_r(buf, ",", &save); tok;
+         tok = strtok_r(NULL, ",", &save)) {
+        v = atoi(tok);
+        if (v < lo || v > hi) {
+            fprintf(stderr, "'%s' is not in [%d, %d]\n", tok, lo, hi);
+            return -1;
+        }
+        if (count < max_count)
+            values[count++] = v;
+    }
+    return count;
+}
+
+/* --threads: "sweep" for 1, 2, 4, ... up to max_threads capped at
+ * MAX_THREADS, or a list */
+static int parse_thread_list(const char *arg, int max_threads, int *counts) {
+    int t, count = 0;
+
+    if (strcmp(arg, "sweep"))
+        return parse_int_list(arg, 1, MAX_THREADS, MAX_THREAD_COUNTS,
+                              counts);
+    if (max_threads > MAX_THREADS)
+        max_threads = MAX_THREADS;
+    for (t = 1; t < max_threads && count < MAX_THREAD_COUNTS - 1; t *= 2)
+        counts[count++] = t;
+    counts[count++] = max_threads;
+    return count;
+}
+
+static int selected(const char *impl, const char *const *impls,
+                    int n_impls) {
+    int i;
+    if (n_impls == 0)
+        return 1;
+    for (i = 0; i < n_impls; i++)
+        if (!strcmp(impl, impls[i]))
+            return 1;
+    return 0;
+}
+
+static void print_usage(const char *exe) {
+    printf("usage: %s [-h] [-v] [--header] [-i IMPL]... [-n SIZE] "
+           "[-m MIN_SIZE]\n"
+           "       [-r INNER_LOOPS] [-s OUTER_LOOPS] [-p PREFIX] "
+           "[-o OFFSETS]\n"
+           "       [--threads LIST]\n", exe);
+}
+
+int main(int argc, char *argv[]) {
+    const char *impls[MAX_IMPLS];
+    double *x, *y, *src, *dst, cpe;
+    long n, reps, l;
+    int i, o, t, xo, yo, n_impls = 0;
+
+    /* Default options */
+    long size = DEFAULT_SIZE;
+    long min_size = DEFAULT_MIN_SIZE;
+    int outer_loops = DEFAULT_OUTER_LOOPS;
+    int inner_loops = DEFAULT_INNER_LOOPS;
+    int verbose = 0;
+    int header = 0;
+    char *prefix = DEFAULT_PREFIX;
+    int offsets[MAX_OFFSETS];
+    int n_offsets = parse_int_list(DEFAULT_OFFSETS, 0, MAX_OFFSET - 1,
+                                   MAX_OFFSETS, offsets);
+    int max_threads = omp_get_max_threads();
+    int thread_counts[MAX_THREAD_COUNTS] = {1};
+    int n_thread_counts = 1;
+
+    static const struct option longopts[] = {
+        {"impl", required_argument, NULL, 'i'},
+        {"size", required_argument, NULL, 'n'},
+        {"min-size", required_argument, NULL, 'm'},
+        {"inner-loops", required_argument, NULL, 'r'},
+        {"outer-loops", required_argument, NULL, 's'},
+        {"prefix", required_argument, NULL, 'p'},
+        {"offsets", required_argument, NULL, 'o'},
+        {"threads", required_argument, NULL, 't'},
+        {"verbose", no_argument, NULL, 'v'},
+        {"header", no_argument, NULL, 'w'},
+        {"help", no_argument, NULL, 'h'},
+        {0, 0, 0, 0}};
+
+    int opt;
+    int optind = 0;
+    while ((opt = getopt_long(argc, argv, "vhi:n:m:r:s:p:o:t:", longopts,
+                              &optind)) != -1) {
+        switch (opt) {
+        case 'i':
+            if (n_impls < MAX_IMPLS)
+                impls[n_impls++] = optarg;
+            break;
+        case 'n':
+            size = atol(optarg);
+            break;
+        case 'm':
+            min_size = atol(optarg);
+            break;
+        case 'r':
+            inner_loops = atol(optarg);
+            break;
+        case 's':
+            outer_loops = atol(optarg);
+            break;
+        case 'p':
+            prefix = optarg;
+            break;
+        case 'o':
+            n_offsets = parse_int_list(optarg, 0, MAX_OFFSET - 1,
+                                       MAX_OFFSETS, offsets);
+            if (n_offsets < 0)
+                return EXIT_FAILURE;
+            break;
+        case 't':
+            n_thread_counts = parse_thread_list(optarg, max_threads,
+                                                thread_counts);
+            if (n_thread_counts < 0)
+                return EXIT_FAILURE;
+            break;
+        case 'h':
+            print_usage(argv[0]);
+            printf("\nBenchmark of float64 array copies\n"
+                   "\noptional arguments:\n"
+                   "  -h, --help\t\tshow this help message and exit\n"
+                   "  -v, --verbose\t\tprint extra messages\n"
+                   "  --header\t\tprint CSV header\n"
+                   "  -i IMPL, --impl IMPL\timplementation to run, may be "
+                   "repeated (default all)\n"
+                   "  -n SIZE, --size SIZE\tlargest problem size "
+                   "(default %d)\n"
+                   "  -m MIN_SIZE, --min-size MIN_SIZE\n"
+                   "\t\t\tsmallest problem size, doubled up to SIZE "
+                   "(default %d)\n"
+                   "  -r INNER_LOOPS, --inner-loops INNER_LOOPS\n"
+                   "\t\t\tnumber of inner iterations to run at SIZE, "
+                   "taking the min;\n"
+                   "\t\t\tsmaller sizes run proportionally more "
+                   "(default %d)\n"
+                   "  -s OUTER_LOOPS, --outer-loops OUTER_LOOPS\n"
+                   "\t\t\tnumber of outer iterations to run, no aggregation "
+                   "(default %d)\n"
+                   "  -p PREFIX, --prefix PREFIX\n"
+                   "\t\t\tbookkeeping string "
+                   "to report with data (default '%s')\n"
+                   "  -o OFFSETS, --offsets OFFSETS\n"
+                   "\t\t\tcomma separated offsets from a cache line in "
+                   "elements,\n"
+                   "\t\t\tfor source and destination (default %s)\n"
+                   "  --threads LIST\tcomma separated thread counts, or "
+                   "'sweep' for 1, 2, 4, ...\n"
+                   "\t\t\tup to all cores (default 1)\n",
+                   DEFAULT_SIZE, DEFAULT_MIN_SIZE, DEFAULT_INNER_LOOPS,
+                   DEFAULT_OUTER_LOOPS, DEFAULT_PREFIX, DEFAULT_OFFSETS);
+            return EXIT_SUCCESS;
+        case 'v':
+            verbose = 1;
+            break;
+        case 'w':
+            header = 1;
+            break;
+        case '?':
+        default:
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (size < 1 || min_size < 1 || min_size > size) {
+        fprintf(stderr, "need 1 <= MIN_SIZE <= SIZE\n");
+        return EXIT_FAILURE;
+    }
+
+    timer_calibrate();
+    if (verbose) {
+        timer_print(stdout, "@");
+        printf("@ implementations:");
+        for (i = 0; i < N_COPIES; i++)
+            printf(" %s", copies[i].impl);
+        printf("\n@ threads:");
+        for (t = 0; t < n_thread_counts; t++)
+            printf(" %d", thread_counts[t]);
+        printf("\n@ sizes = %ld..%ld; outer_loops = %d; inner_loops = %d\n",
+               min_size, size, outer_loops, inner_loops);
+    }
+
+    x = (double *) aligned_alloc(
+        64, (size + MAX_OFFSET + 7) / 8 * 8 * sizeof(double));
+    y = (double *) aligned_alloc(
+        64, (size + MAX_OFFSET + 7) / 8 * 8 * sizeof(double));
+    for (l = 0; l < size + MAX_OFFSET; l++)
+        x[l] = (double) l;
+
+    if (header)
+        puts("Prefix, Implementation, Function, Size, CPE, GB/s, Threads, "
+             "Offset:src, Offset:dst");
+
+    for (o = 0; o < outer_loops; o++) {
+        for (t = 0; t < n_thread_counts; t++) {
+            for (i = 0; i < N_COPIES; i++) {
+                const copy_t *c = &copies[i];
+
+                if (!selected(c->impl, impls, n_impls))
+                    continue;
+                for (n = min_size;; n = 2 * n < size ? 2 * n : size) {
+                    /* as many elements at every size as reps at SIZE */
+                    reps = inner_loops * (size / n);
+                    if (reps > MAX_REPS)
+                        reps = inner_loops > MAX_REPS ? inner_loops
+                                                      : MAX_REPS;
+                    for (xo = 0; xo < n_offsets; xo++) {
+                        for (yo = 0; yo < n_offsets; yo++) {
+                            src = x + offsets[xo];
+                            dst = y + offsets[yo];
+                            memset(dst, 0, n * sizeof(double));
+                            cpe = time_cpe(c, thread_counts[t], n, reps, src,
+                                           dst);
+                            assert(!memcmp(dst, src, n * sizeof(double)));
+                            printf("%s, %s, copy, %ld, %.4g, %.4g, %d, %d, "
+                                   "%d\n", prefix, c->impl, n, cpe,
+                                   16 * timer_state.ghz / cpe,
+                                   thread_counts[t], offsets[xo],
+                                   offsets[yo]);
+                        }
+                    }
+                    if (n == size)
+                        break;
+                }
+            }
+        }
+    }
+
+    free(x);
+    free(y);
+    return EXIT_SUCCESS;
+}
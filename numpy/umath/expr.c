@@ -0,0 +1,506 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "expr.h"
+#include "pool.h"
+#include <assert.h>
+#include <ctype.h>
+#include <math.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__INTEL_LLVM_COMPILER)
+#include "mkl.h"
+#include <mathimf.h>
+#else
+#include "vecmath.h"
+#endif
+
+/*
+ * Compiler: recursive descent over the text, emitting instructions as
+ * soon as both operands are known. Registers are freed when consumed, so
+ * the program needs as many as the deepest pending subexpression.
+ */
+
+struct parser {
+    const char *p;
+    struct expr *e;
+    unsigned busy; /* registers in use */
+    int error;
+};
+
+static const struct {
+    const char *name;
+    enum expr_op op;
+    double (*fold)(double);
+} functions[] = {
+    {"sqrt", EXPR_SQRT, sqrt}, {"exp", EXPR_EXP, exp},
+    {"log", EXPR_LOG, log},    {"log10", EXPR_LOG10, log10},
+    {"sin", EXPR_SIN, sin},    {"cos", EXPR_COS, cos},
+    {"tanh", EXPR_TANH, tanh}, {"erf", EXPR_ERF, erf},
+};
+
+#define N_FUNCTIONS (int) (sizeof(functions) / sizeof(functions[0]))
+
+static void fail(struct parser *ps, const char *what) {
+    if (!ps->error)
+        fprintf(stderr, "expression error: %s at '%s'\n", what, ps->p);
+    ps->error = 1;
+}
+
+static void skip_space(struct parser *ps) {
+    while (isspace((unsigned char) *ps->p))
+        ps->p++;
+}
+
+static struct expr_operand constant(double value) {
+    struct expr_operand o = {EXPR_CONST, 0, value};
+    return o;
+}
+
+static void release(struct parser *ps, struct expr_operand o) {
+    if (o.kind == EXPR_REG)
+        ps->busy &= ~(1u << o.index);
+}
+
+static struct expr_operand emit(struct parser *ps, enum expr_op op,
+                                struct expr_operand a,
+                                struct expr_operand b) {
+    struct expr *e = ps->e;
+    struct expr_operand dst = {EXPR_REG, 0, 0.0};
+    struct expr_insn *in;
+
+    if (e->n_code == EXPR_MAX_CODE) {
+        fail(ps, "expression too long");
+        return dst;
+    }
+    /* the sources are read before the destination is written at every
+     * element, so dst may reuse one of their registers */
+    release(ps, a);
+    release(ps, b);
+    while (ps->busy & (1u << dst.index))
+        dst.index++;
+    if (dst.index == 32) {
+        fail(ps, "expression too deep");
+        return dst;
+    }
+    ps->busy |= 1u << dst.index;
+    if (dst.index + 1 > e->n_regs)
+        e->n_regs = dst.index + 1;
+
+    in = &e->code[e->n_code++];
+    in->op = op;
+    in->dst = dst;
+    in->src[0] = a;
+    in->src[1] = b;
+    return dst;
+}
+
+static double fold_binary(enum expr_op op, double a, double b) {
+    switch (op) {
+    case EXPR_ADD:
+        return a + b;
+    case EXPR_SUB:
+        return a - b;
+    case EXPR_MUL:
+        return a * b;
+    default:
+        return a / b;
+    }
+}
+
+static struct expr_operand binary(struct parser *ps, enum expr_op op,
+                                  struct expr_operand a,
+                                  struct expr_operand b) {
+    if (a.kind == EXPR_CONST && b.kind == EXPR_CONST)
+        return constant(fold_binary(op, a.value, b.value));
+    return emit(ps, op, a, b);
+}
+
+static struct expr_operand parse_sum(struct parser *ps);
+
+static struct expr_operand parse_identifier(struct parser *ps) {
+    struct expr *e = ps->e;
+    struct expr_operand o = {EXPR_INPUT, 0, 0.0}, arg;
+    char name[EXPR_MAX_NAME];
+    int len = 0, i;
+
+    while (isalnum((unsigned char) *ps->p) || *ps->p == '_') {
+        if (len < EXPR_MAX_NAME - 1)
+            name[len++] = *ps->p;
+        ps->p++;
+    }
+    name[len] = '\0';
+    skip_space(ps);
+
+    if (*ps->p == '(') {
+        for (i = 0; i < N_FUNCTIONS; i++)
+            if (!strcmp(name, functions[i].name))
+                break;
+        if (i == N_FUNCTIONS) {
+            fail(ps, "unknown function");
+            return o;
+        }
+        ps->p++;
+        arg = parse_sum(ps);
+        skip_space(ps);
+        if (*ps->p != ')') {
+            fail(ps, "expected ')'");
+            return o;
+        }
+        ps->p++;
+        if (arg.kind == EXPR_CONST)
+            return constant(functions[i].fold(arg.value));
+        return emit(ps, functions[i].op, arg, constant(0.0));
+    }
+
+    for (i = 0; i < e->n_inputs; i++)
+        if (!strcmp(name, e->names[i]))
+            break;
+    if (i == e->n_inputs) {
+        if (i == EXPR_MAX_INPUTS) {
+            fail(ps, "too many inputs");
+            return o;
+        }
+        strcpy(e->names[e->n_inputs++], name);
+    }
+    o.index = i;
+    return o;
+}
+
+static struct expr_operand parse_primary(struct parser *ps) {
+    struct expr_operand o = constant(0.0);
+    char *end;
+
+    skip_space(ps);
+    if (*ps->p == '-') {
+        ps->p++;
+        o = parse_primary(ps);
+        if (o.kind == EXPR_CONST)
+            return constant(-o.value);
+        return emit(ps, EXPR_NEG, o, constant(0.0));
+    }
+    if (*ps->p == '(') {
+        ps->p++;
+        o = parse_sum(ps);
+        skip_space(ps);
+        if (*ps->p != ')')
+            fail(ps, "expected ')'");
+        else
+            ps->p++;
+        return o;
+    }
+    if (isalpha((unsigned char) *ps->p) || *ps->p == '_')
+        return parse_identifier(ps);
+
+    o.value = strtod(ps->p, &end);
+    if (end == ps->p)
+        fail(ps, "expected a number, a name or '('");
+    ps->p = end;
+    return o;
+}
+
+static struct expr_operand parse_product(struct parser *ps) {
+    struct expr_operand a = parse_primary(ps), b;
+    enum expr_op op;
+
+    for (;;) {
+        skip_space(ps);
+        if (*ps->p != '*' && *ps->p != '/')
+            return a;
+        op = *ps->p++ == '*' ? EXPR_MUL : EXPR_DIV;
+        b = parse_primary(ps);
+        a = binary(ps, op, a, b);
+    }
+}
+
+static struct expr_operand parse_sum(struct parser *ps) {
+    struct expr_operand a = parse_product(ps), b;
+    enum expr_op op;
+
+    for (;;) {
+        skip_space(ps);
+        if (*ps->p != '+' && *ps->p != '-')
+            return a;
+        op = *ps->p++ == '+' ? EXPR_ADD : EXPR_SUB;
+        b = parse_product(ps);
+        a = binary(ps, op, a, b);
+    }
+}
+
+int expr_compile(struct expr *e, const char *text) {
+    struct parser ps = {text, e, 0, 0};
+    struct expr_operand result;
+
+    memset(e, 0, sizeof(*e));
+    result = parse_sum(&ps);
+    skip_space(&ps);
+    if (*ps.p)
+        fail(&ps, "unexpected character");
+    if (ps.error)
+        return -1;
+
+    /* the last instruction writes the output directly; an input or a
+     * constant on its own is copied */
+    if (result.kind != EXPR_REG)
+        emit(&ps, EXPR_COPY, result, constant(0.0));
+    if (ps.error)
+        return -1;
+    e->code[e->n_code - 1].dst.kind = EXPR_OUTPUT;
+    e->code[e->n_code - 1].dst.index = 0;
+    return 0;
+}
+
+static int is_array(struct expr_operand o) {
+    return o.kind != EXPR_CONST;
+}
+
+static int is_binary(enum expr_op op) {
+    return op >= EXPR_ADD && op <= EXPR_DIV;
+}
+
+double expr_bytes(const struct expr *e, enum expr_strategy strategy) {
+    int i, arrays = 0;
+
+    /* fused: the inputs are read and the output written once */
+    if (strategy != EXPR_OP_AT_A_TIME)
+        return 8.0 * (e->n_inputs + 1);
+
+    /* op at a time: every instruction streams its array operands in and
+     * its result out */
+    for (i = 0; i < e->n_code; i++) {
+        const struct expr_insn *in = &e->code[i];
+        arrays += 1 + is_array(in->src[0]);
+        if (is_binary(in->op))
+            arrays += is_array(in->src[1]);
+    }
+    return 8.0 * arrays;
+}
+
+const char *expr_strategy_name(enum expr_strategy strategy) {
+    static const char *names[] = {"op-at-a-time", "fused",
+#if defined(__INTEL_LLVM_COMPILER)
+                                  "fused-VML"
+#else
+                                  "fused-VecMath"
+#endif
+    };
+    return names[strategy];
+}
+
+/*
+ * Evaluation. Registers are n_max long for EXPR_OP_AT_A_TIME and one block
+ * long per thread otherwise.
+ */
+
+struct expr_eval {
+    const struct expr *e;
+    enum expr_strategy strategy;
+    long block;
+    int threads;
+    double *scratch;
+    long reg_len; /* elements per register */
+};
+
+struct expr_eval *expr_eval_create(const struct expr *e,
+                                   enum expr_strategy strategy, long n_max,
+                                   long block) {
+    struct expr_eval *ev = (struct expr_eval *) calloc(1, sizeof(*ev));
+    size_t bytes;
+
+    assert(ev && block > 0);
+    ev->e = e;
+    ev->strategy = strategy;
+    ev->block = block;
+    ev->threads = omp_get_max_threads();
+    ev->reg_len = strategy == EXPR_OP_AT_A_TIME ? n_max : block;
+    bytes = (size_t) ev->reg_len * (e->n_regs ? e->n_regs : 1) *
+            (strategy == EXPR_OP_AT_A_TIME ? 1 : ev->threads) *
+            sizeof(double);
+    ev->scratch = (double *) aligned_alloc(64, (bytes + 63) / 64 * 64);
+    assert(ev->scratch);
+    /* first touch, and no page faults inside timed regions */
+    memset(ev->scratch, 0, bytes);
+    return ev;
+}
+
+void expr_eval_destroy(struct expr_eval *ev) {
+    free(ev->scratch);
+    free(ev);
+}
+
+/* where an operand's elements begin for the range starting at begin */
+static double *operand_ptr(struct expr_operand o, double *regs, long reg_len,
+                           long reg_begin, const double *const *inputs,
+                           long begin, double *out) {
+    switch (o.kind) {
+    case EXPR_REG:
+        return regs + o.index * reg_len + reg_begin;
+    case EXPR_INPUT:
+        return (double *) inputs[o.index] + begin;
+    case EXPR_OUTPUT:
+        return out + begin;
+    default:
+        return NULL;
+    }
+}
+
+#define BINARY_LOOP(OP)                                                       \
+    if (!a)                                                                   \
+        for (i = 0; i < len; i++)                                             \
+            y[i] = ca OP b[i];                                                \
+    else if (!b)                                                              \
+        for (i = 0; i < len; i++)                                             \
+            y[i] = a[i] OP cb;                                                \
+    else                                                                      \
+        for (i = 0; i < len; i++)                                             \
+            y[i] = a[i] OP b[i];
+
+#define UNARY_LOOP(f)                                                         \
+    for (i = 0; i < len; i++)                                                 \
+        y[i] = f(a[i]);
+
+/* the functions of a block through VML or vecmath; 0 if not covered */
+static int vector_call(enum expr_op op, long len, const double *a,
+                       double *y) {
+#if defined(__INTEL_LLVM_COMPILER)
+    switch (op) {
+    case EXPR_SQRT: vdSqrt(len, a, y); return 1;
+    case EXPR_EXP: vdExp(len, a, y); return 1;
+    case EXPR_LOG: vdLn(len, a, y); return 1;
+    case EXPR_LOG10: vdLog10(len, a, y); return 1;
+    case EXPR_SIN: vdSin(len, a, y); return 1;
+    case EXPR_COS: vdCos(len, a, y); return 1;
+    case EXPR_TANH: vdTanh(len, a, y); return 1;
+    case EXPR_ERF: vdErf(len, a, y); return 1;
+    default: return 0;
+    }
+#else
+    switch (op) {
+    case EXPR_EXP: vm_exp(len, a, y); return 1;
+    case EXPR_LOG: vm_log(len, a, y); return 1;
+    case EXPR_LOG10: vm_log10(len, a, y); return 1;
+    case EXPR_SIN: vm_sin(len, a, y); return 1;
+    case EXPR_COS: vm_cos(len, a, y); return 1;
+    case EXPR_TANH: vm_tanh(len, a, y); return 1;
+    case EXPR_ERF: vm_erf(len, a, y); return 1;
+    default: return 0;
+    }
+#endif
+}
+
+/* one instruction over len elements */
+static void run_insn(const struct expr_insn *in, long len, double *y,
+                     const double *a, const double *b, int vector) {
+    double ca = in->src[0].value, cb = in->src[1].value;
+    long i;
+
+    if (vector && vector_call(in->op, len, a, y))
+        return;
+
+    switch (in->op) {
+    case EXPR_COPY:
+        if (a)
+            memmove(y, a, len * sizeof(*y));
+        else
+            for (i = 0; i < len; i++)
+                y[i] = ca;
+        break;
+    case EXPR_NEG:
+        UNARY_LOOP(-)
+        break;
+    case EXPR_ADD:
+        BINARY_LOOP(+)
+        break;
+    case EXPR_SUB:
+        BINARY_LOOP(-)
+        break;
+    case EXPR_MUL:
+        BINARY_LOOP(*)
+        break;
+    case EXPR_DIV:
+        BINARY_LOOP(/)
+        break;
+    case EXPR_SQRT:
+        UNARY_LOOP(sqrt)
+        break;
+    case EXPR_EXP:
+        UNARY_LOOP(exp)
+        break;
+    case EXPR_LOG:
+        UNARY_LOOP(log)
+        break;
+    case EXPR_LOG10:
+        UNARY_LOOP(log10)
+        break;
+    case EXPR_SIN:
+        UNARY_LOOP(sin)
+        break;
+    case EXPR_COS:
+        UNARY_LOOP(cos)
+        break;
+    case EXPR_TANH:
+        UNARY_LOOP(tanh)
+        break;
+    case EXPR_ERF:
+        UNARY_LOOP(erf)
+        break;
+    }
+}
+
+/* n_code instructions over [begin, begin + len), registers at reg_begin */
+static void run_code(const struct expr_insn *code, int n_code, double *regs,
+                     long reg_len, long reg_begin, const double *const *inputs,
+                     long begin, long len, double *out, int vector) {
+    int k;
+
+    for (k = 0; k < n_code; k++) {
+        const struct expr_insn *in = &code[k];
+        run_insn(in, len,
+                 operand_ptr(in->dst, regs, reg_len, reg_begin, inputs, begin,
+                             out),
+                 operand_ptr(in->src[0], regs, reg_len, reg_begin, inputs,
+                             begin, out),
+                 operand_ptr(in->src[1], regs, reg_len, reg_begin, inputs,
+                             begin, out),
+                 vector);
+    }
+}
+
+void expr_evaluate(struct expr_eval *ev, long n, const double *const *inputs,
+                   double *out) {
+    const struct expr *e = ev->e;
+    long blocks = (n + ev->block - 1) / ev->block, k;
+    int i;
+
+    if (ev->strategy == EXPR_OP_AT_A_TIME) {
+        /* one parallel sweep per instruction, like one ufunc call each */
+        for (i = 0; i < e->n_code; i++) {
+#pragma omp parallel
+            {
+                long begin, end;
+                pool_split(n, omp_get_num_threads(), omp_get_thread_num(),
+                           &begin, &end);
+                if (begin < end)
+                    run_code(&e->code[i], 1, ev->scratch, ev->reg_len, begin,
+                             inputs, begin, end - begin, out, 0);
+            }
+        }
+        return;
+    }
+
+#pragma omp parallel for schedule(static)
+    for (k = 0; k < blocks; k++) {
+        double *regs = ev->scratch + (size_t) omp_get_thread_num() *
+                                         ev->reg_len * e->n_regs;
+        long begin = k * ev->block;
+        long len = begin + ev->block < n ? ev->block : n - begin;
+        run_code(e->code, e->n_code, regs, ev->reg_len, 0, inputs, begin, len,
+                 out, ev->strategy == EXPR_FUSED_VECTOR);
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * A small numexpr-style engine for elementwise expressions over double
+ * arrays, e.g. "a*b+c" or "exp(-x*x)/sqrt(y)". The text is compiled into
+ * a register program, which is evaluated with one of three strategies:
+ *
+ *   EXPR_OP_AT_A_TIME  every operation sweeps the whole arrays and writes
+ *                      full-size temporaries, as a chain of numpy ufuncs
+ *   EXPR_FUSED         the program runs on blocks small enough that the
+ *                      temporaries stay in L1, as numexpr and numba do
+ *   EXPR_FUSED_VECTOR  fused, with the functions of each block computed by
+ *                      VML (icx) or vecmath (other compilers)
+ *
+ * Identifiers are inputs, numbered in order of first appearance. The
+ * operators are unary -, +, -, *, / and the functions sqrt, exp, log,
+ * log10, sin, cos, tanh and erf. Constant subexpressions are folded.
+ */
+
+#ifndef __EXPR_H
+#define __EXPR_H
+
+#define EXPR_MAX_INPUTS 8
+#define EXPR_MAX_CODE 64
+#define EXPR_MAX_NAME 16
+
+enum expr_op {
+    EXPR_COPY,
+    EXPR_NEG,
+    EXPR_ADD,
+    EXPR_SUB,
+    EXPR_MUL,
+    EXPR_DIV,
+    EXPR_SQRT,
+    EXPR_EXP,
+    EXPR_LOG,
+    EXPR_LOG10,
+    EXPR_SIN,
+    EXPR_COS,
+    EXPR_TANH,
+    EXPR_ERF
+};
+
+enum expr_strategy { EXPR_OP_AT_A_TIME, EXPR_FUSED, EXPR_FUSED_VECTOR };
+
+enum expr_kind { EXPR_REG, EXPR_INPUT, EXPR_CONST, EXPR_OUTPUT };
+
+struct expr_operand {
+    enum expr_kind kind;
+    int index;    /* register or input number */
+    double value; /* EXPR_CONST */
+};
+
+struct expr_insn {
+    enum expr_op op;
+    struct expr_operand dst, src[2];
+};
+
+struct expr {
+    int n_inputs, n_regs, n_code;
+    char names[EXPR_MAX_INPUTS][EXPR_MAX_NAME];
+    struct expr_insn code[EXPR_MAX_CODE];
+};
+
+/* returns 0, or -1 after printing the problem to stderr */
+int expr_compile(struct expr *e, const char *text);
+
+/* bytes per element moved to and from memory by a strategy */
+double expr_bytes(const struct expr *e, enum expr_strategy strategy);
+
+const char *expr_strategy_name(enum expr_strategy strategy);
+
+struct expr_eval;
+
+/* scratch for n_max elements; block is the fused block length */
+struct expr_eval *expr_eval_create(const struct expr *e,
+                                   enum expr_strategy strategy, long n_max,
+                                   long block);
+void expr_eval_destroy(struct expr_eval *ev);
+
+/* out[i] = expression of inputs[k][i] for i < n, over the OpenMP threads */
+void expr_evaluate(struct expr_eval *ev, long n, const double *const *inputs,
+                   double *out);
+
+#endif /* __EXPR_H */
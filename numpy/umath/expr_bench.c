@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Fusion benchmark: the expressions numexpr and numba are used for,
+ * evaluated op at a time with full-size temporaries (numpy), fused in
+ * L1-sized blocks, and fused with a vector math library call per block.
+ * Rows report CPE, the memory traffic of the strategy in bytes per element
+ * and the bandwidth that amounts to.
+ */
+
+#include "expr.h"
+#include "timer.h"
+#include <getopt.h>
+#include <math.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__INTEL_LLVM_COMPILER)
+#include "mkl.h"
+#endif
+
+#define DEFAULT_INNER_LOOPS 200
+#define DEFAULT_OUTER_LOOPS 1
+#define DEFAULT_SIZE 2500000
+#define DEFAULT_MIN_SIZE 1024
+/* numexpr's block length for doubles */
+#define DEFAULT_BLOCK 1024
+#define DEFAULT_PREFIX "Native-C"
+#define MAX_EXPRESSIONS 32
+#define MAX_REPS (1 << 16)
+
+/* fused results may differ from op at a time by this much, relative to
+ * max(1, |reference|), when the functions come from another library */
+#if defined(_VML_ACCURACY_EP_)
+#define TOLERANCE 1e-6
+#else
+#define TOLERANCE 1e-12
+#endif
+
+#define N_STRATEGIES 3
+
+static const char *default_expressions[] = {
+    "a*b+c", "2*a+3*b", "exp(-x*x)/sqrt(y)", "sin(x)*sin(x)+cos(x)*cos(x)",
+    "tanh(a)*b+log(c)"};
+
+static void fill_uniform(unsigned long long *state, long n, double *x) {
+    long i;
+    for (i = 0; i < n; i++) {
+        *state ^= *state << 13;
+        *state ^= *state >> 7;
+        *state ^= *state << 17;
+        /* [0.5, 1.5), inside the domain of every function */
+        x[i] = 0.5 + (double) (*state >> 11) * 0x1p-53;
+    }
+}
+
+/* best of reps evaluations, in ticks per element */
+static double time_cpe(struct expr_eval *ev, long n, long reps,
+                       const double *const *inputs, double *out) {
+    double cpe, cpe_min = 1e300;
+    timer_ticks t0, t1;
+    long j;
+
+    for (j = 0; j < reps; j++) {
+        t0 = timer_start();
+        expr_evaluate(ev, n, inputs, out);
+        t1 = timer_stop();
+        cpe = timer_elapsed(t0, t1) / n;
+        if (cpe < cpe_min)
+            cpe_min = cpe;
+    }
+    return cpe_min;
+}
+
+/* largest difference of y from ref, relative to max(1, |ref|) */
+static double max_error(long n, const double *ref, const double *y) {
+    double err = 0.0, d;
+    long i;
+    for (i = 0; i < n; i++) {
+        d = fabs(y[i] - ref[i]) / fmax(1.0, fabs(ref[i]));
+        if (!(d <= err))
+            err = d;
+    }
+    return err;
+}
+
+static void print_usage(const char *exe) {
+    printf("usage: %s [-h] [-v] [--header] [-e EXPR]... [-n SIZE] "
+           "[-m MIN_SIZE]\n"
+           "       [-b BLOCK] [-r INNER_LOOPS] [-s OUTER_LOOPS] "
+           "[-p PREFIX]\n", exe);
+}
+
+int main(int argc, char *argv[]) {
+    const char *texts[MAX_EXPRESSIONS];
+    struct expr exprs[MAX_EXPRESSIONS];
+    struct expr_eval *ev;
+    double *inputs[EXPR_MAX_INPUTS], *ref, *out, cpe, bytes, err;
+    unsigned long long state = 77777;
+    long n, reps;
+    int i, k, s, o, n_texts = 0, status = EXIT_SUCCESS;
+
+    /* Default options */
+    long size = DEFAULT_SIZE;
+    long min_size = DEFAULT_MIN_SIZE;
+    long block = DEFAULT_BLOCK;
+    int outer_loops = DEFAULT_OUTER_LOOPS;
+    int inner_loops = DEFAULT_INNER_LOOPS;
+    int verbose = 0;
+    int header = 0;
+    char *prefix = DEFAULT_PREFIX;
+
+    static const struct option longopts[] = {
+        {"expr", required_argument, NULL, 'e'},
+        {"size", required_argument, NULL, 'n'},
+        {"min-size", required_argument, NULL, 'm'},
+        {"block", required_argument, NULL, 'b'},
+        {"inner-loops", required_argument, NULL, 'r'},
+        {"outer-loops", required_argument, NULL, 's'},
+        {"prefix", required_argument, NULL, 'p'},
+        {"verbose", no_argument, NULL, 'v'},
+        {"header", no_argument, NULL, 'w'},
+        {"help", no_argument, NULL, 'h'},
+        {0, 0, 0, 0}};
+
+    int opt;
+    int optind = 0;
+    while ((opt = getopt_long(argc, argv, "vhe:n:m:b:r:s:p:", longopts,
+                              &optind)) != -1) {
+        switch (opt) {
+        case 'e':
+            if (n_texts < MAX_EXPRESSIONS)
+                texts[n_texts++] = optarg;
+            break;
+        case 'n':
+            size = atol(optarg);
+            break;
+        case 'm':
+            min_size = atol(optarg);
+            break;
+        case 'b':
+            block = atol(optarg);
+            break;
+        case 'r':
+            inner_loops = atol(optarg);
+            break;
+        case 's':
+            outer_loops = atol(optarg);
+            break;
+        case 'p':
+            prefix = optarg;
+            break;
+        case 'h':
+            print_usage(argv[0]);
+            printf("\nBenchmark of fused against op-at-a-time evaluation of "
+                   "array expressions\n"
+                   "\noptional arguments:\n"
+                   "  -h, --help\t\tshow this help message and exit\n"
+                   "  -v, --verbose\t\tprint extra messages\n"
+                   "  --header\t\tprint CSV header\n"
+                   "  -e EXPR, --expr EXPR\texpression over named arrays, "
+                   "may be repeated\n"
+                   "\t\t\t(default a few numexpr-style expressions)\n"
+                   "  -n SIZE, --size SIZE\tlargest problem size "
+                   "(default %d)\n"
+                   "  -m MIN_SIZE, --min-size MIN_SIZE\n"
+                   "\t\t\tsmallest problem size, doubled up to SIZE "
+                   "(default %d)\n"
+                   "  -b BLOCK, --block BLOCK\n"
+                   "\t\t\telements per block of the fused strategies "
+                   "(default %d)\n"
+                   "  -r INNER_LOOPS, --inner-loops INNER_LOOPS\n"
+                   "\t\t\tnumber of inner iterations to run at SIZE, "
+                   "taking the min;\n"
+                   "\t\t\tsmaller sizes run proportionally more "
+                   "(default %d)\n"
+                   "  -s OUTER_LOOPS, --outer-loops OUTER_LOOPS\n"
+                   "\t\t\tnumber of outer iterations to run, no aggregation "
+                   "(default %d)\n"
+                   "  -p PREFIX, --prefix PREFIX\n"
+                   "\t\t\tbookkeeping string "
+                   "to report with data (default '%s')\n",
+                   DEFAULT_SIZE, DEFAULT_MIN_SIZE, DEFAULT_BLOCK,
+                   DEFAULT_INNER_LOOPS, DEFAULT_OUTER_LOOPS, DEFAULT_PREFIX);
+            return EXIT_SUCCESS;
+        case 'v':
+            verbose = 1;
+            break;
+        case 'w':
+            header = 1;
+            break;
+        case '?':
+        default:
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (size < 1 || min_size < 1 || min_size > size || block < 1) {
+        fprintf(stderr, "need 1 <= MIN_SIZE <= SIZE and BLOCK >= 1\n");
+        return EXIT_FAILURE;
+    }
+    if (n_texts == 0) {
+        n_texts = sizeof(default_expressions) / sizeof(*default_expressions);
+        memcpy(texts, default_expressions, sizeof(default_expressions));
+    }
+    for (i = 0; i < n_texts; i++)
+        if (expr_compile(&exprs[i], texts[i]))
+            return EXIT_FAILURE;
+
+#if defined(_VML_ACCURACY_EP_)
+    vmlSetMode(VML_EP | VML_ERRMODE_DEFAULT | VML_FTZDAZ_OFF);
+#elif defined(_VML_ACCURACY_HA_)
+    vmlSetMode(VML_HA | VML_ERRMODE_DEFAULT | VML_FTZDAZ_OFF);
+#elif defined(_VML_ACCURACY_LA_)
+    vmlSetMode(VML_LA | VML_ERRMODE_DEFAULT | VML_FTZDAZ_OFF);
+#endif
+
+    timer_calibrate();
+    if (verbose) {
+        timer_print(stdout, "@");
+        printf("@ threads = %d; block = %ld; sizes = %ld..%ld; "
+               "outer_loops = %d; inner_loops = %d\n",
+               omp_get_max_threads(), block, min_size, size, outer_loops,
+               inner_loops);
+        for (i = 0; i < n_texts; i++)
+            printf("@ %s: %d inputs, %d instructions, %d registers\n",
+                   texts[i], exprs[i].n_inputs, exprs[i].n_code,
+                   exprs[i].n_regs);
+    }
+
+    for (k = 0; k < EXPR_MAX_INPUTS; k++) {
+        inputs[k] = (double *) aligned_alloc(64, size * sizeof(double));
+        fill_uniform(&state, size, inputs[k]);
+    }
+    ref = (double *) aligned_alloc(64, size * sizeof(double));
+    out = (double *) aligned_alloc(64, size * sizeof(double));
+
+    /* fused strategies must agree with op at a time before being timed */
+    for (i = 0; i < n_texts; i++) {
+        ev = expr_eval_create(&exprs[i], EXPR_OP_AT_A_TIME, size, block);
+        expr_evaluate(ev, size, (const double *const *) inputs, ref);
+        expr_eval_destroy(ev);
+        for (s = 1; s < N_STRATEGIES; s++) {
+            ev = expr_eval_create(&exprs[i], s, size, block);
+            expr_evaluate(ev, size, (const double *const *) inputs, out);
+            expr_eval_destroy(ev);
+            err = max_error(size, ref, out);
+            if (verbose || !(err <= TOLERANCE))
+                printf("@ validate %s, %s: max error %.3g %s\n", texts[i],
+                       expr_strategy_name(s), err,
+                       err <= TOLERANCE ? "pass" : "FAIL");
+            if (!(err <= TOLERANCE))
+                status = EXIT_FAILURE;
+        }
+    }
+
+    if (header)
+        puts("Prefix, Strategy, Expression, Size, CPE, Bytes, GB/s");
+
+    for (o = 0; o < outer_loops; o++) {
+        for (i = 0; i < n_texts; i++) {
+            for (s = 0; s < N_STRATEGIES; s++) {
+                ev = expr_eval_create(&exprs[i], s, size, block);
+                bytes = expr_bytes(&exprs[i], s);
+                for (n = min_size;; n = 2 * n < size ? 2 * n : size) {
+                    /* as many elements at every size as reps at SIZE */
+                    reps = inner_loops * (size / n);
+                    if (reps > MAX_REPS)
+                        reps = inner_loops > MAX_REPS ? inner_loops
+                                                      : MAX_REPS;
+                    cpe = time_cpe(ev, n, reps,
+                                   (const double *const *) inputs, out);
+                    printf("%s, %s, %s, %ld, %.4g, %.0f, %.4g\n", prefix,
+                           expr_strategy_name(s), texts[i], n, cpe, bytes,
+                           bytes * timer_state.ghz / cpe);
+                    if (n == size)
+                        break;
+                }
+                expr_eval_destroy(ev);
+            }
+        }
+    }
+
+    for (k = 0; k < EXPR_MAX_INPUTS; k++)
+        free(inputs[k]);
+    free(ref);
+    free(out);
+    return status;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "isa.h"
+#include <string.h>
+
+static const char *isa_names[ISA_COUNT] = {"sse42", "avx2", "avx512_256",
+                                           "avx512"};
+
+int isa_supported(enum isa isa) {
+    __builtin_cpu_init();
+    switch (isa) {
+    case ISA_SSE42:
+        return __builtin_cpu_supports("sse4.2");
+    case ISA_AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case ISA_AVX512_256:
+    case ISA_AVX512:
+        /* the subsets -xCORE-AVX512 compiles for */
+        return __builtin_cpu_supports("avx512f") &&
+               __builtin_cpu_supports("avx512cd") &&
+               __builtin_cpu_supports("avx512bw") &&
+               __builtin_cpu_supports("avx512dq") &&
+               __builtin_cpu_supports("avx512vl");
+    default:
+        return 0;
+    }
+}
+
+enum isa isa_best(void) {
+    int isa;
+    for (isa = ISA_COUNT - 1; isa > ISA_SSE42; isa--)
+        if (isa_supported((enum isa) isa))
+            break;
+    return (enum isa) isa;
+}
+
+const char *isa_name(enum isa isa) {
+    return isa < ISA_COUNT ? isa_names[isa] : "unknown";
+}
+
+int isa_from_name(const char *name) {
+    int isa;
+    for (isa = 0; isa < ISA_COUNT; isa++)
+        if (strcmp(name, isa_names[isa]) == 0)
+            return isa;
+    return -1;
+}
@@ -0,0 +1,27 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Instruction sets the umath kernels are built for. Each kernel exists
+ * once per entry, so all of them can be compared on one machine, e.g.
+ * AVX-512 with 256-bit against 512-bit vectors where the wider registers
+ * lower the clock.
+ */
+
+#ifndef __ISA_H
+#define __ISA_H
+
+enum isa { ISA_SSE42, ISA_AVX2, ISA_AVX512_256, ISA_AVX512, ISA_COUNT };
+
+/* whether the CPU and the OS support isa */
+int isa_supported(enum isa isa);
+/* widest supported entry */
+enum isa isa_best(void);
+const char *isa_name(enum isa isa);
+/* returns -1 for unknown names */
+int isa_from_name(const char *name);
+
+#endif /* __ISA_H */
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "pool.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <x86intrin.h>
+
+/* pause iterations before a worker parks, some tens of microseconds */
+#define POOL_SPIN (1 << 14)
+
+struct worker {
+    struct pool *pool;
+    int index;
+    pthread_t thread;
+};
+
+struct pool {
+    int threads;
+    struct worker *workers;
+
+    /* the current task, published by bumping generation */
+    pool_task task;
+    void *arg;
+    long n;
+    atomic_uint generation;
+    atomic_int pending;
+    atomic_int sleepers;
+    atomic_int stop;
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+};
+
+/* wait for generation to move past seen: spin first, then park */
+static unsigned wait_task(struct pool *pool, unsigned seen) {
+    unsigned gen;
+    int i;
+
+    for (i = 0; i < POOL_SPIN; i++) {
+        gen = atomic_load_explicit(&pool->generation, memory_order_acquire);
+        if (gen != seen)
+            return gen;
+        _mm_pause();
+    }
+
+    /* sleepers is raised before generation is read again and pool_run
+     * bumps generation before reading sleepers, so one of the two sides
+     * sees the other and the wake-up cannot be lost */
+    pthread_mutex_lock(&pool->lock);
+    atomic_fetch_add(&pool->sleepers, 1);
+    while ((gen = atomic_load(&pool->generation)) == seen)
+        pthread_cond_wait(&pool->wake, &pool->lock);
+    atomic_fetch_sub(&pool->sleepers, 1);
+    pthread_mutex_unlock(&pool->lock);
+    return gen;
+}
+
+static void *worker_main(void *arg) {
+    struct worker *w = (struct worker *) arg;
+    struct pool *pool = w->pool;
+    unsigned seen = 0;
+    long begin, end;
+
+    for (;;) {
+        seen = wait_task(pool, seen);
+        if (atomic_load(&pool->stop))
+            break;
+        pool_split(pool->n, pool->threads, w->index, &begin, &end);
+        if (begin < end)
+            pool->task(pool->arg, begin, end);
+        atomic_fetch_sub_explicit(&pool->pending, 1, memory_order_release);
+    }
+    return NULL;
+}
+
+static void publish(struct pool *pool) {
+    atomic_fetch_add_explicit(&pool->generation, 1, memory_order_seq_cst);
+    if (atomic_load(&pool->sleepers) > 0) {
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_broadcast(&pool->wake);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+struct pool *pool_create(int threads) {
+    struct pool *pool = (struct pool *) calloc(1, sizeof(*pool));
+    int i, err;
+
+    assert(pool && threads >= 1);
+    pool->threads = threads;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pool->workers = (struct worker *) calloc(threads, sizeof(*pool->workers));
+    assert(pool->workers);
+
+    for (i = 1; i < threads; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        err = pthread_create(&pool->workers[i].thread, NULL, worker_main,
+                             &pool->workers[i]);
+        assert(err == 0);
+    }
+    return pool;
+}
+
+void pool_destroy(struct pool *pool) {
+    int i;
+
+    atomic_store(&pool->stop, 1);
+    publish(pool);
+    for (i = 1; i < pool->threads; i++)
+        pthread_join(pool->workers[i].thread, NULL);
+
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->workers);
+    free(pool);
+}
+
+int pool_threads(const struct pool *pool) {
+    return pool->threads;
+}
+
+void pool_run(struct pool *pool, pool_task task, void *arg, long n) {
+    long begin, end;
+
+    pool->task = task;
+    pool->arg = arg;
+    pool->n = n;
+    atomic_store_explicit(&pool->pending, pool->threads - 1,
+                          memory_order_relaxed);
+    publish(pool);
+
+    pool_split(n, pool->threads, 0, &begin, &end);
+    if (begin < end)
+        task(arg, begin, end);
+
+    while (atomic_load_explicit(&pool->pending, memory_order_acquire) > 0)
+        _mm_pause();
+}
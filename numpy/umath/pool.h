@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * A persistent thread pool for the umath loops, as an alternative to an
+ * OpenMP parallel region per call. Workers spin for a while after each
+ * task, so back-to-back calls skip the wake-up, and then park on a
+ * condition variable. The calling thread runs the first chunk itself.
+ */
+
+#ifndef __POOL_H
+#define __POOL_H
+
+typedef void (*pool_task)(void *arg, long begin, long end);
+
+struct pool;
+
+/* threads counts the calling thread, so threads - 1 workers are started */
+struct pool *pool_create(int threads);
+void pool_destroy(struct pool *pool);
+int pool_threads(const struct pool *pool);
+
+/* runs task over [0, n) split statically, returns when all chunks are done */
+void pool_run(struct pool *pool, pool_task task, void *arg, long n);
+
+/* chunk t of n elements over threads, in whole cache lines of doubles */
+static inline void pool_split(long n, int threads, int t, long *begin,
+                              long *end) {
+    long chunk = (n + 8 * threads - 1) / (8 * threads) * 8;
+    *begin = t * chunk < n ? t * chunk : n;
+    *end = *begin + chunk < n ? *begin + chunk : n;
+}
+
+#endif /* __POOL_H */
@@ -0,0 +1,639 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Reduction benchmark: np.sum, np.dot of 1-D arrays, np.linalg.norm, min,
+ * max, argmax and mean, each as a naive loop, a loop over N_ACC
+ * independent accumulators the compiler turns into SIMD, numpy's pairwise
+ * summation where numpy uses it, and MKL BLAS under icx. Rows report CPE,
+ * bandwidth and the error relative to a compensated long double sum;
+ * argmax rows report an infinite error when the index is not that of the
+ * first occurrence of the maximum.
+ * Several threads reduce a chunk each and combine the partial results in
+ * order; the MKL rows thread inside MKL instead.
+ */
+
+#include "pool.h"
+#include "timer.h"
+#include <getopt.h>
+#include <math.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__INTEL_LLVM_COMPILER)
+#include "mkl.h"
+#endif
+
+#define DEFAULT_INNER_LOOPS 200
+#define DEFAULT_OUTER_LOOPS 1
+#define DEFAULT_SIZE 2500000
+#define DEFAULT_MIN_SIZE 1024
+#define DEFAULT_PREFIX "Native-C"
+#define MAX_FUNCS 16
+#define MAX_THREAD_COUNTS 16
+#define MAX_THREADS 256
+#define MAX_REPS (1 << 16)
+
+/* independent partial results of the unrolled kernels, enough to cover
+ * the add latency on two ports with 512-bit vectors */
+#define N_ACC 32
+/* numpy's PW_BLOCKSIZE, below which pairwise summation is a plain loop */
+#define PW_BLOCKSIZE 128
+
+/* how the partial results of the threads make up the result */
+enum combine { COMBINE_SUM, COMBINE_MIN, COMBINE_MAX, COMBINE_ARGMAX,
+               COMBINE_NONE };
+/* what is left to do with the combined result */
+enum finish { FINISH_NONE, FINISH_SQRT, FINISH_MEAN };
+
+/* reduces x[0:n], and y[0:n] for dot; argmax stores its index in *arg */
+typedef double (*reduce_kernel)(long n, const double *x, const double *y,
+                                long *arg);
+
+static double sum_naive(long n, const double *x, const double *y,
+                        long *arg) {
+    double s = 0.0;
+    long i;
+    for (i = 0; i < n; i++)
+        s += x[i];
+    return s;
+}
+
+static double sum_unrolled(long n, const double *x, const double *y,
+                           long *arg) {
+    double acc[N_ACC] = {0.0}, s = 0.0;
+    long i = 0;
+    int j;
+
+    for (; i + N_ACC <= n; i += N_ACC)
+        for (j = 0; j < N_ACC; j++)
+            acc[j] += x[i + j];
+    for (j = 0; j < N_ACC; j++)
+        s += acc[j];
+    for (; i < n; i++)
+        s += x[i];
+    return s;
+}
+
+/* numpy's pairwise_sum: eight accumulators per block, blocks halved */
+static double pairwise(long n, const double *x) {
+    double r[8], s;
+    long i, n2;
+    int j;
+
+    if (n < 8) {
+        s = 0.0;
+        for (i = 0; i < n; i++)
+            s += x[i];
+        return s;
+    }
+    if (n <= PW_BLOCKSIZE) {
+        for (j = 0; j < 8; j++)
+            r[j] = x[j];
+        for (i = 8; i < n - n % 8; i += 8)
+            for (j = 0; j < 8; j++)
+                r[j] += x[i + j];
+        s = ((r[0] + r[1]) + (r[2] + r[3])) + ((r[4] + r[5]) + (r[6] + r[7]));
+        for (; i < n; i++)
+            s += x[i];
+        return s;
+    }
+    n2 = n / 2;
+    n2 -= n2 % 8;
+    return pairwise(n2, x) + pairwise(n - n2, x + n2);
+}
+
+static double sum_pairwise(long n, const double *x, const double *y,
+                           long *arg) {
+    return pairwise(n, x);
+}
+
+static double dot_naive(long n, const double *x, const double *y,
+                        long *arg) {
+    double s = 0.0;
+    long i;
+    for (i = 0; i < n; i++)
+        s += x[i] * y[i];
+    return s;
+}
+
+static double dot_unrolled(long n, const double *x, const double *y,
+                           long *arg) {
+    double acc[N_ACC] = {0.0}, s = 0.0;
+    long i = 0;
+    int j;
+
+    for (; i + N_ACC <= n; i += N_ACC)
+        for (j = 0; j < N_ACC; j++)
+            acc[j] += x[i + j] * y[i + j];
+    for (j = 0; j < N_ACC; j++)
+        s += acc[j];
+    for (; i < n; i++)
+        s += x[i] * y[i];
+    return s;
+}
+
+/* the norm kernels return the sum of squares, FINISH_SQRT the root */
+static double sumsq_naive(long n, const double *x, const double *y,
+                          long *arg) {
+    return dot_naive(n, x, x, arg);
+}
+
+static double sumsq_unrolled(long n, const double *x, const double *y,
+                             long *arg) {
+    return dot_unrolled(n, x, x, arg);
+}
+
+static double min_naive(long n, const double *x, const double *y,
+                        long *arg) {
+    double m = x[0];
+    long i;
+    for (i = 1; i < n; i++)
+        if (x[i] < m)
+            m = x[i];
+    return m;
+}
+
+static double max_naive(long n, const double *x, const double *y,
+                        long *arg) {
+    double m = x[0];
+    long i;
+    for (i = 1; i < n; i++)
+        if (x[i] > m)
+            m = x[i];
+    return m;
+}
+
+/* x < m ? x : m is what minpd computes, so these vectorize without
+ * -ffast-math */
+static double min_unrolled(long n, const double *x, const double *y,
+                           long *arg) {
+    double acc[N_ACC], m;
+    long i = N_ACC;
+    int j;
+
+    if (n < N_ACC)
+        return min_naive(n, x, y, arg);
+    for (j = 0; j < N_ACC; j++)
+        acc[j] = x[j];
+    for (; i + N_ACC <= n; i += N_ACC)
+        for (j = 0; j < N_ACC; j++)
+            acc[j] = x[i + j] < acc[j] ? x[i + j] : acc[j];
+    m = acc[0];
+    for (j = 1; j < N_ACC; j++)
+        m = acc[j] < m ? acc[j] : m;
+    for (; i < n; i++)
+        m = x[i] < m ? x[i] : m;
+    return m;
+}
+
+static double max_unrolled(long n, const double *x, const double *y,
+                           long *arg) {
+    double acc[N_ACC], m;
+    long i = N_ACC;
+    int j;
+
+    if (n < N_ACC)
+        return max_naive(n, x, y, arg);
+    for (j = 0; j < N_ACC; j++)
+        acc[j] = x[j];
+    for (; i + N_ACC <= n; i += N_ACC)
+        for (j = 0; j < N_ACC; j++)
+            acc[j] = x[i + j] > acc[j] ? x[i + j] : acc[j];
+    m = acc[0];
+    for (j = 1; j < N_ACC; j++)
+        m = acc[j] > m ? acc[j] : m;
+    for (; i < n; i++)
+        m = x[i] > m ? x[i] : m;
+    return m;
+}
+
+static double argmax_naive(long n, const double *x, const double *y,
+                           long *arg) {
+    long i, best = 0;
+    for (i = 1; i < n; i++)
+        if (x[i] > x[best])
+            best = i;
+    *arg = best;
+    return x[best];
+}
+
+/* the maximum with the unrolled kernel, then its first occurrence */
+static double argmax_twopass(long n, const double *x, const double *y,
+                             long *arg) {
+    double m = max_unrolled(n, x, y, arg);
+    long i = 0;
+    while (x[i] != m)
+        i++;
+    *arg = i;
+    return m;
+}
+
+#if defined(__INTEL_LLVM_COMPILER)
+/* the inputs are positive, so dasum and idamax give sum and argmax */
+static double sum_mkl(long n, const double *x, const double *y, long *arg) {
+    return cblas_dasum(n, x, 1);
+}
+
+static double dot_mkl(long n, const double *x, const double *y, long *arg) {
+    return cblas_ddot(n, x, 1, y, 1);
+}
+
+static double norm_mkl(long n, const double *x, const double *y,
+                       long *arg) {
+    return cblas_dnrm2(n, x, 1);
+}
+
+static double argmax_mkl(long n, const double *x, const double *y,
+                         long *arg) {
+    *arg = cblas_idamax(n, x, 1);
+    return x[*arg];
+}
+#endif
+
+typedef struct reduction_t {
+    const char *func, *impl;
+    reduce_kernel kernel;
+    /* COMBINE_NONE for kernels that thread themselves */
+    enum combine combine;
+    enum finish finish;
+    /* bytes read per element */
+    int bytes;
+} reduction_t;
+
+static const reduction_t reductions[] = {
+    {"sum", "Naive", sum_naive, COMBINE_SUM, FINISH_NONE, 8},
+    {"sum", "Unrolled", sum_unrolled, COMBINE_SUM, FINISH_NONE, 8},
+    {"sum", "Pairwise", sum_pairwise, COMBINE_SUM, FINISH_NONE, 8},
+    {"dot", "Naive", dot_naive, COMBINE_SUM, FINISH_NONE, 16},
+    {"dot", "Unrolled", dot_unrolled, COMBINE_SUM, FINISH_NONE, 16},
+    {"norm", "Naive", sumsq_naive, COMBINE_SUM, FINISH_SQRT, 8},
+    {"norm", "Unrolled", sumsq_unrolled, COMBINE_SUM, FINISH_SQRT, 8},
+    {"min", "Naive", min_naive, COMBINE_MIN, FINISH_NONE, 8},
+    {"min", "Unrolled", min_unrolled, COMBINE_MIN, FINISH_NONE, 8},
+    {"max", "Naive", max_naive, COMBINE_MAX, FINISH_NONE, 8},
+    {"max", "Unrolled", max_unrolled, COMBINE_MAX, FINISH_NONE, 8},
+    {"argmax", "Naive", argmax_naive, COMBINE_ARGMAX, FINISH_NONE, 8},
+    {"argmax", "Unrolled", argmax_twopass, COMBINE_ARGMAX, FINISH_NONE, 8},
+    {"mean", "Naive", sum_naive, COMBINE_SUM, FINISH_MEAN, 8},
+    {"mean", "Unrolled", sum_unrolled, COMBINE_SUM, FINISH_MEAN, 8},
+    {"mean", "Pairwise", sum_pairwise, COMBINE_SUM, FINISH_MEAN, 8},
+#if defined(__INTEL_LLVM_COMPILER)
+    {"sum", "MKL", sum_mkl, COMBINE_NONE, FINISH_NONE, 8},
+    {"dot", "MKL", dot_mkl, COMBINE_NONE, FINISH_NONE, 16},
+    {"norm", "MKL", norm_mkl, COMBINE_NONE, FINISH_NONE, 8},
+    {"argmax", "MKL", argmax_mkl, COMBINE_NONE, FINISH_NONE, 8},
+    {"mean", "MKL", sum_mkl, COMBINE_NONE, FINISH_MEAN, 8},
+#endif
+};
+
+#define N_REDUCTIONS ((int) (sizeof(reductions) / sizeof(*reductions)))
+
+/*
+ * The reduction of x[0:n] on threads threads, each reducing the chunk
+ * pool_split() gives it. Partial sums are added in thread order, so the
+ * result does not depend on scheduling.
+ */
+static double reduce(const reduction_t *r, int threads, long n,
+                     const double *x, const double *y, long *arg) {
+    double part[MAX_THREADS], v;
+    long parg[MAX_THREADS], best = 0;
+    int valid[MAX_THREADS] = {0}, t;
+
+    if (threads == 1 || r->combine == COMBINE_NONE) {
+        v = r->kernel(n, x, y, &best);
+    } else {
+#pragma omp parallel num_threads(threads)
+        {
+            int me = omp_get_thread_num();
+            long begin, end;
+            pool_split(n, omp_get_num_threads(), me, &begin, &end);
+            if (begin < end) {
+                parg[me] = 0;
+                part[me] = r->kernel(end - begin, x + begin,
+                                     y ? y + begin : NULL, &parg[me]);
+                parg[me] += begin;
+                valid[me] = 1;
+            }
+        }
+        /* the first chunk is never empty */
+        v = r->combine == COMBINE_SUM ? 0.0 : part[0];
+        best = parg[0];
+        for (t = 0; t < threads; t++) {
+            if (!valid[t])
+                continue;
+            if (r->combine == COMBINE_SUM) {
+                v += part[t];
+            } else if (r->combine == COMBINE_MIN ? part[t] < v
+                                                 : part[t] > v) {
+                v = part[t];
+                best = parg[t];
+            }
+        }
+    }
+
+    if (arg)
+        *arg = best;
+    if (r->finish == FINISH_SQRT)
+        return sqrt(v);
+    if (r->finish == FINISH_MEAN)
+        return v / n;
+    return v;
+}
+
+/* Neumaier's compensated sum of x[i] * y[i], or of x[i] without y */
+static long double compensated_sum(long n, const double *x,
+                                   const double *y) {
+    long double s = 0.0L, c = 0.0L, v, t;
+    long i;
+
+    for (i = 0; i < n; i++) {
+        v = y ? (long double) x[i] * y[i] : x[i];
+        t = s + v;
+        if (fabsl(s) >= fabsl(v))
+            c += (s - t) + v;
+        else
+            c += (v - t) + s;
+        s = t;
+    }
+    return s + c;
+}
+
+/* the exact result of r's function on x[0:n], and for argmax the index
+ * of the first maximum in *arg */
+static long double reference(const reduction_t *r, long n, const double *x,
+                             const double *y, long *arg) {
+    if (!strcmp(r->func, "argmax"))
+        return argmax_naive(n, x, NULL, arg);
+    if (!strcmp(r->func, "dot"))
+        return compensated_sum(n, x, y);
+    if (!strcmp(r->func, "norm"))
+        return sqrtl(compensated_sum(n, x, x));
+    if (!strcmp(r->func, "mean"))
+        return compensated_sum(n, x, NULL) / n;
+    if (!strcmp(r->func, "min"))
+        return min_naive(n, x, NULL, arg);
+    if (!strcmp(r->func, "max"))
+        return max_naive(n, x, NULL, arg);
+    return compensated_sum(n, x, NULL);
+}
+
+/* best of reps reductions, in ticks per element */
+static double time_cpe(const reduction_t *r, int threads, long n, long reps,
+                       const double *x, const double *y, double *result) {
+    double cpe, cpe_min = 1e300;
+    timer_ticks t0, t1;
+    long j;
+
+    for (j = 0; j < reps; j++) {
+        t0 = timer_start();
+        *result = reduce(r, threads, n, x, y, NULL);
+        t1 = timer_stop();
+        cpe = timer_elapsed(t0, t1) / n;
+        if (cpe < cpe_min)
+            cpe_min = cpe;
+    }
+    return cpe_min;
+}
+
+/* exponential(1) draws with xorshift64, as umath_bench without MKL */
+static void fill_exponential(unsigned long long *state, long n, double *x) {
+    long i;
+    for (i = 0; i < n; i++) {
+        *state ^= *state << 13;
+        *state ^= *state >> 7;
+        *state ^= *state << 17;
+        x[i] = -log1p(-(double) (*state >> 11) * 0x1p-53);
+    }
+}
+
+/*
+ * Parse the --threads argument, "sweep" for 1, 2, 4, ... up to max_threads
+ * capped at MAX_THREADS, or a comma separated list, into counts. Returns
+ * the number of entries, or -1 after printing an error.
+ */
+static int parse_thread_list(const char *arg, int max_threads, int *counts) {
+    char buf[256], *tok, *save;
+    int t, count = 0;
+
+    if (!strcmp(arg, "sweep")) {
+        /* reduce() keeps one partial result per thread on the stack */
+        if (max_threads > MAX_THREADS)
+            max_threads = MAX_THREADS;
+        for (t = 1; t < max_threads && count < MAX_THREAD_COUNTS - 1; t *= 2)
+            counts[count++] = t;
+        counts[count++] = max_threads;
+        return count;
+    }
+
+    snprintf(buf, sizeof(buf), "%s", arg);
+    for (tok = strtok_r(buf, ",", &save); tok;
+         tok = strtok_r(NULL, ",", &save)) {
+        t = atoi(tok);
+        if (t < 1 || t > MAX_THREADS) {
+            fprintf(stderr, "bad thread count '%s'\n", tok);
+            return -1;
+        }
+        if (count < MAX_THREAD_COUNTS)
+            counts[count++] = t;
+    }
+    return count;
+}
+
+static int selected(const char *func, const char *const *funcs,
+                    int n_funcs) {
+    int i;
+    if (n_funcs == 0)
+        return 1;
+    for (i = 0; i < n_funcs; i++)
+        if (!strcmp(func, funcs[i]))
+            return 1;
+    return 0;
+}
+
+static void print_usage(const char *exe) {
+    printf("usage: %s [-h] [-v] [--header] [-f FUNC]... [-n SIZE] "
+           "[-m MIN_SIZE]\n"
+           "       [-r INNER_LOOPS] [-s OUTER_LOOPS] [-p PREFIX] "
+           "[--threads LIST]\n", exe);
+}
+
+int main(int argc, char *argv[]) {
+    const char *funcs[MAX_FUNCS];
+    double *x, *y, cpe, value = 0.0;
+    long double ref, err;
+    unsigned long long state = 77777;
+    long n, reps, arg = 0, ref_arg = 0;
+    int i, o, t, n_funcs = 0;
+
+    /* Default options */
+    long size = DEFAULT_SIZE;
+    long min_size = DEFAULT_MIN_SIZE;
+    int outer_loops = DEFAULT_OUTER_LOOPS;
+    int inner_loops = DEFAULT_INNER_LOOPS;
+    int verbose = 0;
+    int header = 0;
+    char *prefix = DEFAULT_PREFIX;
+    int max_threads = omp_get_max_threads();
+    int thread_counts[MAX_THREAD_COUNTS] = {1};
+    int n_thread_counts = 1;
+
+    static const struct option longopts[] = {
+        {"func", required_argument, NULL, 'f'},
+        {"size", required_argument, NULL, 'n'},
+        {"min-size", required_argument, NULL, 'm'},
+        {"inner-loops", required_argument, NULL, 'r'},
+        {"outer-loops", required_argument, NULL, 's'},
+        {"prefix", required_argument, NULL, 'p'},
+        {"threads", required_argument, NULL, 't'},
+        {"verbose", no_argument, NULL, 'v'},
+        {"header", no_argument, NULL, 'w'},
+        {"help", no_argument, NULL, 'h'},
+        {0, 0, 0, 0}};
+
+    int opt;
+    int optind = 0;
+    while ((opt = getopt_long(argc, argv, "vhf:n:m:r:s:p:t:", longopts,
+                              &optind)) != -1) {
+        switch (opt) {
+        case 'f':
+            if (n_funcs < MAX_FUNCS)
+                funcs[n_funcs++] = optarg;
+            break;
+        case 'n':
+            size = atol(optarg);
+            break;
+        case 'm':
+            min_size = atol(optarg);
+            break;
+        case 'r':
+            inner_loops = atol(optarg);
+            break;
+        case 's':
+            outer_loops = atol(optarg);
+            break;
+        case 'p':
+            prefix = optarg;
+            break;
+        case 't':
+            n_thread_counts = parse_thread_list(optarg, max_threads,
+                                                thread_counts);
+            if (n_thread_counts < 0)
+                return EXIT_FAILURE;
+            break;
+        case 'h':
+            print_usage(argv[0]);
+            printf("\nBenchmark of reductions: sum, dot, norm, min, max, "
+                   "argmax and mean\n"
+                   "\noptional arguments:\n"
+                   "  -h, --help\t\tshow this help message and exit\n"
+                   "  -v, --verbose\t\tprint extra messages\n"
+                   "  --header\t\tprint CSV header\n"
+                   "  -f FUNC, --func FUNC\tfunction to run, may be "
+                   "repeated (default all)\n"
+                   "  -n SIZE, --size SIZE\tlargest problem size "
+                   "(default %d)\n"
+                   "  -m MIN_SIZE, --min-size MIN_SIZE\n"
+                   "\t\t\tsmallest problem size, doubled up to SIZE "
+                   "(default %d)\n"
+                   "  -r INNER_LOOPS, --inner-loops INNER_LOOPS\n"
+                   "\t\t\tnumber of inner iterations to run at SIZE, "
+                   "taking the min;\n"
+                   "\t\t\tsmaller sizes run proportionally more "
+                   "(default %d)\n"
+                   "  -s OUTER_LOOPS, --outer-loops OUTER_LOOPS\n"
+                   "\t\t\tnumber of outer iterations to run, no aggregation "
+                   "(default %d)\n"
+                   "  -p PREFIX, --prefix PREFIX\n"
+                   "\t\t\tbookkeeping string "
+                   "to report with data (default '%s')\n"
+                   "  --threads LIST\tcomma separated thread counts, or "
+                   "'sweep' for 1, 2, 4, ...\n"
+                   "\t\t\tup to all cores (default 1)\n",
+                   DEFAULT_SIZE, DEFAULT_MIN_SIZE, DEFAULT_INNER_LOOPS,
+                   DEFAULT_OUTER_LOOPS, DEFAULT_PREFIX);
+            return EXIT_SUCCESS;
+        case 'v':
+            verbose = 1;
+            break;
+        case 'w':
+            header = 1;
+            break;
+        case '?':
+        default:
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (size < 1 || min_size < 1 || min_size > size) {
+        fprintf(stderr, "need 1 <= MIN_SIZE <= SIZE\n");
+        return EXIT_FAILURE;
+    }
+
+    timer_calibrate();
+    if (verbose) {
+        timer_print(stdout, "@");
+        printf("@ threads:");
+        for (t = 0; t < n_thread_counts; t++)
+            printf(" %d", thread_counts[t]);
+        printf("\n@ accumulators = %d; sizes = %ld..%ld; outer_loops = %d; "
+               "inner_loops = %d\n",
+               N_ACC, min_size, size, outer_loops, inner_loops);
+    }
+
+    x = (double *) aligned_alloc(64, (size + 7) / 8 * 8 * sizeof(double));
+    y = (double *) aligned_alloc(64, (size + 7) / 8 * 8 * sizeof(double));
+    fill_exponential(&state, size, x);
+    fill_exponential(&state, size, y);
+
+    if (header)
+        puts("Prefix, Implementation, Function, Size, CPE, GB/s, Threads, "
+             "Error");
+
+    for (o = 0; o < outer_loops; o++) {
+        for (t = 0; t < n_thread_counts; t++) {
+#if defined(__INTEL_LLVM_COMPILER)
+            mkl_set_num_threads(thread_counts[t]);
+#endif
+            for (i = 0; i < N_REDUCTIONS; i++) {
+                const reduction_t *r = &reductions[i];
+                const double *ry = !strcmp(r->func, "dot") ? y : NULL;
+
+                if (!selected(r->func, funcs, n_funcs))
+                    continue;
+                for (n = min_size;; n = 2 * n < size ? 2 * n : size) {
+                    /* as many elements at every size as reps at SIZE */
+                    reps = inner_loops * (size / n);
+                    if (reps > MAX_REPS)
+                        reps = inner_loops > MAX_REPS ? inner_loops
+                                                      : MAX_REPS;
+                    cpe = time_cpe(r, thread_counts[t], n, reps, x, ry,
+                                   &value);
+                    ref = reference(r, n, x, ry, &ref_arg);
+                    err = fabsl(value - ref) / fabsl(ref);
+                    if (!strcmp(r->func, "argmax")) {
+                        reduce(r, thread_counts[t], n, x, ry, &arg);
+                        if (arg != ref_arg)
+                            err = INFINITY;
+                    }
+                    printf("%s, %s, %s, %ld, %.4g, %.4g, %d, %.3Lg\n", prefix,
+                           r->impl, r->func, n, cpe,
+                           r->bytes * timer_state.ghz / cpe, thread_counts[t],
+                           err);
+                    if (n == size)
+                        break;
+                }
+            }
+        }
+    }
+
+    free(x);
+    free(y);
+    return EXIT_SUCCESS;
+}
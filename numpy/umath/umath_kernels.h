@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * The compiler-vectorized loops of umath_bench, which use SVML under icx.
+ * umath_kernels.c.src is built once per entry of isa.h with the matching
+ * -x (icx) or -m (GCC, Clang) flags, and each build exports its own table.
+ * The kernels are serial; the driver splits arrays over OpenMP or the
+ * pool of pool.h.
+ */
+
+#ifndef __UMATH_KERNELS_H
+#define __UMATH_KERNELS_H
+
+#include "isa.h"
+#include <complex.h>
+
+typedef void (*umath_binary)(long n, const double *x1, const double *x2,
+                             double *y);
+typedef void (*umath_scalar)(long n, const double *x1, double c, double *y);
+typedef void (*umath_unary)(long n, const double *x1, double *y);
+/* y[i] = f(x1[i * inc]) */
+typedef void (*umath_strided)(long n, const double *x1, long inc, double *y);
+/* y[i] = f(x1[idx[i]]) */
+typedef void (*umath_gather)(long n, const double *x1, const long *idx,
+                             double *y);
+/* float32, complex64 and complex128 counterparts of umath_binary and
+ * umath_unary */
+typedef void (*umath_binary_f32)(long n, const float *x1, const float *x2,
+                                 float *y);
+typedef void (*umath_unary_f32)(long n, const float *x1, float *y);
+typedef void (*umath_binary_c64)(long n, const float complex *x1,
+                                 const float complex *x2, float complex *y);
+typedef void (*umath_unary_c64)(long n, const float complex *x1,
+                                float complex *y);
+typedef void (*umath_binary_c128)(long n, const double complex *x1,
+                                  const double complex *x2,
+                                  double complex *y);
+typedef void (*umath_unary_c128)(long n, const double complex *x1,
+                                 double complex *y);
+
+/*
+ * The unary functions, in the order and with the names of
+ * umath_mem_bench.py, plus invsqrt. They index the per-function arrays
+ * below.
+ */
+enum umath_func {
+    UMATH_SIN,
+    UMATH_COS,
+    UMATH_TAN,
+    UMATH_SINH,
+    UMATH_COSH,
+    UMATH_TANH,
+    UMATH_SQRT,
+    UMATH_LOG10,
+    UMATH_LOG,
+    UMATH_EXP,
+    UMATH_EXPM1,
+    UMATH_ARCSIN,
+    UMATH_ERF,
+    UMATH_ARCCOS,
+    UMATH_ARCTAN,
+    UMATH_ARCSINH,
+    UMATH_ARCCOSH,
+    UMATH_ARCTANH,
+    UMATH_LOG1P,
+    UMATH_EXP2,
+    UMATH_LOG2,
+    UMATH_INVSQRT,
+    /* f(x) = x, which also packs strided inputs */
+    UMATH_COPYTO,
+    UMATH_N_FUNCS
+};
+
+struct umath_kernels {
+    /* y = x1 op x2 */
+    umath_binary add, sub, mul, div;
+    /* y = x1 op c */
+    umath_scalar add_scalar, sub_scalar, mul_scalar, div_scalar;
+    /* y = c op x1 */
+    umath_scalar scalar_add, scalar_sub, scalar_mul, scalar_div;
+    /* y = f(x1), indexed by enum umath_func */
+    umath_unary unary[UMATH_N_FUNCS];
+    /* the same with nontemporal stores of y, for outputs beyond the LLC */
+    umath_binary add_nt, sub_nt, mul_nt, div_nt;
+    umath_unary unary_nt[UMATH_N_FUNCS];
+    umath_strided strided[UMATH_N_FUNCS];
+    umath_gather gather[UMATH_N_FUNCS];
+    umath_binary_f32 add_f32, sub_f32, mul_f32, div_f32;
+    umath_unary_f32 unary_f32[UMATH_N_FUNCS];
+    umath_binary_c64 add_c64, sub_c64, mul_c64, div_c64;
+    umath_unary_c64 exp_c64, log_c64, sin_c64, cos_c64, tanh_c64, sqrt_c64;
+    umath_binary_c128 add_c128, sub_c128, mul_c128, div_c128;
+    umath_unary_c128 exp_c128, log_c128, sin_c128, cos_c128, tanh_c128,
+        sqrt_c128;
+};
+
+extern const struct umath_kernels umath_kernels_sse42, umath_kernels_avx2,
+    umath_kernels_avx512_256, umath_kernels_avx512;
+
+#endif /* __UMATH_KERNELS_H */
@@ -35,12 +35,16 @@ def_funcs = ['+', '-', '*', '/', 'sin', 'cos', 'tan', 'sinh', 'cosh', 'tanh',
     'sqrt', 'log10', 'log', 'exp', 'expm1', 'arcsin', 'erf',
     'arccos', 'arctan', 'arcsinh', 'arccosh', 'arctanh', 'log1p', 'exp2', 'log2', 'copyto']
 def_impls = ['numpy', 'numexpr', 'numba']
+def_types = ['float64', 'float32', 'complex128', 'complex64']
+def_inputs = ['uniform', 'denormal', 'special', 'huge']
 
 argParser.add_argument('-l', '--log',       default=None,      help="log")
 argParser.add_argument('-p', '--prefix',    default='@',       help="prefix string")
 argParser.add_argument('-s', '--size',      default=def_sizes, help="size of array", nargs='+', type=int)
 argParser.add_argument('-f', '--func',      default=def_funcs, help="function(s) to test", nargs='+', type=str)
-argParser.add_argument('-m', '--impl',      default=def_impls, help="implementation(s) to test", nargs='+', type=str)
+argParser.add_argument('-m', '--impl',      default=def_impls, help="implementation(s) to test, or 'native' for the float64 kernels of libumath_native.so (make native)", nargs='+', type=str)
+argParser.add_argument('-t', '--dtype',     default=def_types, help="element type(s) to test", nargs='+', type=str)
+argParser.add_argument('-i', '--inputs',    default=['uniform'], help="input distribution(s) out of " + ", ".join(def_inputs), nargs='+', choices=def_inputs)
 argParser.add_argument('-g', '--goal-time', default=1,         help="goal for measured time in ms")
 argParser.add_argument('-r', '--repeats',   default=30,        help="repeat experements and get minimum time")
 argParser.add_argument('-o', '--offsets',   default=(0,1,2,4), help="Offset from aligned in elements", nargs='+', type=int)
@@ -55,14 +59,29 @@ for impl in args.impl:
     if impl == "numexpr":
         import numexpr
     if impl == "numba":
-        import numba, math
+        import numba, math, cmath
         if "OMP_NUM_THREADS" in os.environ:
             run_par = numba.config.NUMBA_DEFAULT_NUM_THREADS = int(os.environ["OMP_NUM_THREADS"])
         run_par = numba.config.NUMBA_DEFAULT_NUM_THREADS > 1
+    if impl == "native":
+        import ctypes
+        try:
+            native = ctypes.CDLL(os.path.join(os.path.dirname(os.path.abspath(__file__)), 'libumath_native.so'))
+        except OSError as e:
+            sys.exit("%s\nbuild it with 'make -C numpy/umath native'" % e)
+        native.run_kernel.restype = ctypes.c_double
+        native.run_kernel.argtypes = [ctypes.c_char_p, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_long, ctypes.c_long]
+        native.native_ghz.restype = ctypes.c_double
+        # clock units per tick of run_kernel, both TSC unless clock is default_timer
+        native_clock_scale = 2 / native.native_ghz() if clock_name.startswith('default_timer') else 1
 
 goalTime = float(args.goal_time)/1000.
 scalararraytypes = range(0, 3)
-np_types = [np.float64]
+np_types = [np.dtype(t).type for t in args.dtype]
+# numba signature names of np_types
+nb_types = {np.float64: 'f8', np.float32: 'f4', np.complex128: 'c16', np.complex64: 'c8'}
+if args.inputs != ['uniform']:
+    np.seterr(all='ignore') # NaN, inf and out of domain results are expected
 overheadMin = 0
 
 def numbaKernel(params, code, sigs):
@@ -74,31 +93,56 @@ def numbaKernel(params, code, sigs):
          """.format(**locals()))
     return numba.njit(sigs, parallel=run_par, fastmath=args.fast_math)(locals()[n])
 
-def getBinaryFuncImpl(func, impl, scalar):
-    if impl == "numexpr":
+class nativeKernel:
+    """A kernel of libumath_native.so, which times itself, see runBenchNative"""
+    def __init__(self, name, np_type):
+        if np_type != np.float64:
+            raise NotImplementedError("native kernels are float64 only")
+        self.name = name
+
+    def run(self, z, x, y, internalCount):
+        if self.name == 'copyto': # np.copyto(dst, src) takes the output first
+            x, z = z, x
+        # scalars become arrays of one element, the library reads x[0] or y[0]
+        x, y = [None if a is None else np.ascontiguousarray(np.atleast_1d(a), dtype=np.float64) for a in (x, y)]
+        ticks = native.run_kernel(self.name.encode(), x.ctypes.data, None if y is None else y.ctypes.data,
+                                  z.ctypes.data, z.size, internalCount)
+        if ticks < 0:
+            raise NotImplementedError("no native kernel " + self.name)
+        return ticks
+
+def getBinaryFuncImpl(func, impl, scalar, np_type):
+    if impl == 'native':
+        return nativeKernel(['array%sarray', 'array%sscalar', 'scalar%sarray'][scalar] % func, np_type)
+    elif impl == "numexpr":
         return lambda x,y,out: numexpr.evaluate("x %s y"%func, out=out)
     elif impl == 'numpy':
         return {'+': np.add, '*': np.multiply, '/':  np.true_divide, '-': np.subtract}[func]
     elif impl == 'numba':
+      t = nb_types[np_type]
       if scalar == 0:
-        return numbaKernel("x,y", "x[i] %s y[i]"%func, "(f8[::1],f8[::1],f8[::1])")
+        return numbaKernel("x,y", "x[i] %s y[i]"%func, "({t}[::1],{t}[::1],{t}[::1])".format(t=t))
       elif scalar == 1:
-        return numbaKernel("x,y", "x[i] %s y"%func, "(f8[::1],f8,f8[::1])")
+        return numbaKernel("x,y", "x[i] %s y"%func, "({t}[::1],{t},{t}[::1])".format(t=t))
       elif scalar == 2:
-        return numbaKernel("x,y", "x %s y[i]"%func, "(f8,f8[::1],f8[::1])")
+        return numbaKernel("x,y", "x %s y[i]"%func, "({t},{t}[::1],{t}[::1])".format(t=t))
     raise NotImplementedError(impl)
 
-def getUnaryFuncImpl(func, impl):
-    if impl == "numexpr":
+def getUnaryFuncImpl(func, impl, np_type):
+    if impl == 'native':
+        return nativeKernel(func, np_type)
+    elif impl == "numexpr":
         if func == 'invsqrt':
             return lambda x,out: numexpr.evaluate("1/sqrt(x)", out=out)
         else:
             return lambda x,out: numexpr.evaluate("%s(x)"%func, out=out)
     elif impl == 'numba':
+        sig = "({t}[::1],{t}[::1])".format(t=nb_types[np_type])
+        mod = "cmath" if np.issubdtype(np_type, np.complexfloating) else "math"
         if func == 'invsqrt':
-            return numbaKernel("x", "1./math.sqrt(x[i])", "(f8[::1],f8[::1])")
+            return numbaKernel("x", "1./%s.sqrt(x[i])"%mod, sig)
         else:
-            return numbaKernel("x", "math.%s(x[i])"%func, "(f8[::1],f8[::1])")
+            return numbaKernel("x", "%s.%s(x[i])"%(mod, func), sig)
     elif impl == 'numpy':
         try:
             ufunc = getattr(np.core.umath, func, None)
@@ -137,8 +181,18 @@ def runBenchBinary(func, z, x, y, internalCount, timer):
     return t0, t1
 
 
+# the native kernels time themselves, without the loop and call overhead above
+def runBenchNative(func, z, x, y, internalCount, timer):
+    ticks = func.run(z, x, y, internalCount)
+    scale = native_clock_scale if timer is clock else 1 / (native.native_ghz() * 1e9)
+    return 0, ticks * scale
+
+
 def runBench(func, z, x, y = None, internalCount=1, externalCount=int(args.repeats), timer=clock, overhead=overheadMin):
-    if y is None:
+    if isinstance(func, nativeKernel):
+       run = lambda: runBenchNative(func, z, x, y, internalCount, timer)
+       overhead = 0
+    elif y is None:
        run = lambda: runBenchUnary(func, z, x, internalCount, timer)
     else:
        run = lambda: runBenchBinary(func, z, x, y, internalCount, timer)
@@ -178,19 +232,38 @@ def checkResults(CPEs):
 def clOffset(a):
     return int(a.__array_interface__['data'][0]) % 64
 
+def distribute(a, dist):
+    # subnormal; NaN, inf, zero and negative in every 8th element; or
+    # log-uniform from 1e6 up, where sin and cos need full range reduction.
+    # Python cannot set FTZ/DAZ, so these run with denormals handled exactly
+    finfo = np.finfo(a.dtype)
+    if dist == 'denormal':
+        a = a * (finfo.tiny / 4)
+    elif dist == 'special':
+        a = a.copy()
+        a[::8] = np.resize(np.array([np.nan, np.inf, -np.inf, 0, -1], dtype=a.dtype), a[::8].size)
+    elif dist == 'huge':
+        a = (a * 10 ** np.random.uniform(6, np.log10(float(finfo.max) / 10), size=a.size)).astype(a.dtype)
+    return a
+
 overheadMin = runBench(emptyF, 0, 0, internalCount=100000, overhead=0)
 print("Overhead time per loop iteration = ",  overheadMin, " clock = ", clock_name)
-print("Prefix,Implementation,Function,Type,Iterations,Size,CPE:aligned,CPE:max")
+print("Prefix,Implementation,Function,Type,Iterations,Size,CPE:aligned,CPE:max,Input")
 
-for np_type in np_types:
+for np_type, dist in itertools.product(np_types, args.inputs):
   zoffsets = xoffsets = yoffsets = args.offsets
   znoffs = len(zoffsets)
   xnoffs = len(xoffsets)
   ynoffs = len(yoffsets)
   for n in args.size:
-    z0 = np.asarray(np.random.uniform(2.1, 2.9, size=n+27), dtype=np_type) # if binary function is passed with -f
-    x0 = np.asarray(np.random.uniform(0.1, 0.9, size=n+27), dtype=np_type) # 27 is a random non-power-of-two > 16
-    y0 = np.asarray(np.random.uniform(1.1, 1.9, size=n+27), dtype=np_type) # > 1 for hyperbolic functions
+    z0 = np.asarray(np.random.uniform(2.1, 2.9, size=n+43), dtype=np_type) # if binary function is passed with -f
+    x0 = np.asarray(np.random.uniform(0.1, 0.9, size=n+43), dtype=np_type) # 43 leaves room for 16 + the float32 alignment offset
+    y0 = np.asarray(np.random.uniform(1.1, 1.9, size=n+43), dtype=np_type) # > 1 for hyperbolic functions
+    if np.issubdtype(np_type, np.complexfloating):
+        z0 += 1j * np.random.uniform(0.1, 0.9, size=n+43)
+        x0 += 1j * np.random.uniform(0.1, 0.9, size=n+43)
+        y0 += 1j * np.random.uniform(0.1, 0.9, size=n+43)
+    z0, x0, y0 = distribute(z0, dist), distribute(x0, dist), distribute(y0, dist)
     if clOffset(z0) != 0 or clOffset(x0) != 0 or clOffset(y0) != 0:
         zoff = int((64-clOffset(z0))%64/z0.itemsize)
         xoff = int((64-clOffset(x0))%64/x0.itemsize)
@@ -202,7 +275,7 @@ for np_type in np_types:
     assert(clOffset(z0) == 0)
     assert(clOffset(x0) == 0)
     assert(clOffset(y0) == 0)
-    assert(np.all(y0 > 0))
+    assert(dist != 'uniform' or np.all(y0.real > 0))
 
     for impl in args.impl:
       for func in args.func:
@@ -211,7 +284,7 @@ for np_type in np_types:
               op = func
               CPEs = np.zeros([znoffs,xnoffs,ynoffs])
               for scalararraytype in scalararraytypes:
-                np_func = getBinaryFuncImpl(func, impl, scalararraytype)
+                np_func = getBinaryFuncImpl(func, impl, scalararraytype, np_type)
                 if scalararraytype == 0:
                     x,y,z = x0,y0,z0
                 elif scalararraytype == 1:
@@ -255,9 +328,9 @@ for np_type in np_types:
                 elif scalararraytype == 2:
                     satype = 'scalar%sarray' % op
                 checkResults(CPEs)
-                print(args.prefix, '% 7s'%impl, '% 12s'%satype, np_type.__name__, '% 7d'%internalCount, '% 7d'%n, '% 6.2f'%CPEs[0][0][0], '% 6.2f'%np.max(CPEs), sep=', ', flush=True)
+                print(args.prefix, '% 7s'%impl, '% 12s'%satype, np_type.__name__, '% 7d'%internalCount, '% 7d'%n, '% 6.2f'%CPEs[0][0][0], '% 6.2f'%np.max(CPEs), dist, sep=', ', flush=True)
             else: # unary operation
-                np_func = getUnaryFuncImpl(func, impl)
+                np_func = getUnaryFuncImpl(func, impl, np_type)
                 CPEs = np.zeros([znoffs,xnoffs])
                 a0 = y0 if func in ['arccosh'] else x0 # otherwise it results in a complex number
                 internalCount, internalTime = getInternalCount(np_func, z0, a0)
@@ -279,6 +352,6 @@ for np_type in np_types:
                         satype = 'c[%d:]=% 7s(a[%d:])'%(clOffset(z)/z.itemsize, func, clOffset(x)/x.itemsize)
                         print(args.prefix, '% 7s'%impl, satype, np_type.__name__, '% 6d'%internalCount, '% 7d'%n, '% 4.2f'%CPE_min, sep=', ', flush=True)
                 checkResults(CPEs)
-                print(args.prefix, '% 7s'%impl, '% 12s'%func, np_type.__name__, '% 7d'%internalCount, '% 7d'%n, '% 6.2f'%CPEs[0][0], '% 6.2f'%np.max(CPEs), sep=', ', flush=True)
+                print(args.prefix, '% 7s'%impl, '% 12s'%func, np_type.__name__, '% 7d'%internalCount, '% 7d'%n, '% 6.2f'%CPEs[0][0], '% 6.2f'%np.max(CPEs), dist, sep=', ', flush=True)
         except Exception as e:
             print("Failed while executing %s for %s: %s" % (func, impl, str(e)))
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * libumath_native.so: the serial Loop kernels of the widest ISA this CPU
+ * supports behind the ABI of native.h. Names are those of the Function
+ * column: "array+array" computes out = x + y, "array+scalar" out = x + y[0]
+ * and "scalar+array" out = x[0] + y, likewise for -, * and /, and the unary
+ * functions of umath_mem_bench.py, "sin" to "copyto" and "invsqrt", compute
+ * out = f(x). Every array is float64.
+ */
+
+#include "isa.h"
+#include "native.h"
+#include "timer.h"
+#include "umath_kernels.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *const func_names[UMATH_N_FUNCS] = {
+    [UMATH_SIN] = "sin",         [UMATH_COS] = "cos",
+    [UMATH_TAN] = "tan",         [UMATH_SINH] = "sinh",
+    [UMATH_COSH] = "cosh",       [UMATH_TANH] = "tanh",
+    [UMATH_SQRT] = "sqrt",       [UMATH_LOG10] = "log10",
+    [UMATH_LOG] = "log",         [UMATH_EXP] = "exp",
+    [UMATH_EXPM1] = "expm1",     [UMATH_ARCSIN] = "arcsin",
+    [UMATH_ERF] = "erf",         [UMATH_ARCCOS] = "arccos",
+    [UMATH_ARCTAN] = "arctan",   [UMATH_ARCSINH] = "arcsinh",
+    [UMATH_ARCCOSH] = "arccosh", [UMATH_ARCTANH] = "arctanh",
+    [UMATH_LOG1P] = "log1p",     [UMATH_EXP2] = "exp2",
+    [UMATH_LOG2] = "log2",       [UMATH_INVSQRT] = "invsqrt",
+    [UMATH_COPYTO] = "copyto"};
+
+/* indexed by enum isa */
+static const struct umath_kernels *const kernels_by_isa[ISA_COUNT] = {
+    &umath_kernels_sse42, &umath_kernels_avx2, &umath_kernels_avx512_256,
+    &umath_kernels_avx512};
+
+double native_ghz(void) {
+    return timer_calibrate()->ghz;
+}
+
+double run_kernel(const char *name, const double *x, const double *y,
+                  double *out, long n, long reps) {
+    static const char ops[] = "+-*/";
+    const struct umath_kernels *k = kernels_by_isa[isa_best()];
+    const umath_binary binary[] = {k->add, k->sub, k->mul, k->div};
+    const umath_scalar array_scalar[] = {k->add_scalar, k->sub_scalar,
+                                         k->mul_scalar, k->div_scalar};
+    const umath_scalar scalar_array[] = {k->scalar_add, k->scalar_sub,
+                                         k->scalar_mul, k->scalar_div};
+    umath_binary b = NULL;
+    umath_scalar s = NULL;
+    umath_unary u = NULL;
+    const double *a = x;
+    double c = 0.0;
+    char buf[16];
+    timer_ticks t0, t1;
+    long j;
+    int i;
+
+    timer_calibrate();
+    for (i = 0; i < 4; i++) {
+        snprintf(buf, sizeof(buf), "array%carray", ops[i]);
+        if (!strcmp(name, buf))
+            b = binary[i];
+        snprintf(buf, sizeof(buf), "array%cscalar", ops[i]);
+        if (!strcmp(name, buf)) {
+            s = array_scalar[i];
+            c = y[0];
+        }
+        snprintf(buf, sizeof(buf), "scalar%carray", ops[i]);
+        if (!strcmp(name, buf)) {
+            s = scalar_array[i];
+            a = y;
+            c = x[0];
+        }
+    }
+    for (i = 0; i < UMATH_N_FUNCS; i++)
+        if (!strcmp(name, func_names[i]))
+            u = k->unary[i];
+    if (!b && !s && !u)
+        return -1.0;
+
+    t0 = timer_start();
+    for (j = 0; j < reps; j++) {
+        if (b)
+            b(n, x, y, out);
+        else if (s)
+            s(n, a, c, out);
+        else
+            u(n, x, out);
+    }
+    t1 = timer_stop();
+    return timer_elapsed(t0, t1);
+}
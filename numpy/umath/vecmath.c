@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "vecmath.h"
+#include <stddef.h>
+
+typedef void (*vm_func)(long n, const double *a, double *y);
+
+struct vm_table {
+    vm_func exp, log, log10, erf, sin, cos, tanh, invsqrt;
+};
+
+#define VM_DECLARE(isa)                                                       \
+    void vm_exp_##isa(long n, const double *a, double *y);                   \
+    void vm_log_##isa(long n, const double *a, double *y);                   \
+    void vm_log10_##isa(long n, const double *a, double *y);                 \
+    void vm_erf_##isa(long n, const double *a, double *y);                   \
+    void vm_sin_##isa(long n, const double *a, double *y);                   \
+    void vm_cos_##isa(long n, const double *a, double *y);                   \
+    void vm_tanh_##isa(long n, const double *a, double *y);                  \
+    void vm_invsqrt_##isa(long n, const double *a, double *y);
+
+#define VM_TABLE(isa)                                                         \
+    {                                                                         \
+        vm_exp_##isa, vm_log_##isa, vm_log10_##isa, vm_erf_##isa,             \
+            vm_sin_##isa, vm_cos_##isa, vm_tanh_##isa, vm_invsqrt_##isa       \
+    }
+
+VM_DECLARE(sse42)
+VM_DECLARE(avx2)
+VM_DECLARE(avx512_256)
+VM_DECLARE(avx512)
+
+static const struct vm_table tables[ISA_COUNT] = {
+    VM_TABLE(sse42), VM_TABLE(avx2), VM_TABLE(avx512_256), VM_TABLE(avx512)};
+
+static const struct vm_table *active = NULL;
+static enum isa active_isa;
+
+int vm_set_isa(enum isa isa) {
+    if (!isa_supported(isa))
+        return -1;
+    active_isa = isa;
+    active = &tables[isa];
+    return 0;
+}
+
+enum isa vm_get_isa(void) {
+    if (!active)
+        vm_set_isa(isa_best());
+    return active_isa;
+}
+
+static const struct vm_table *table(void) {
+    if (!active)
+        vm_set_isa(isa_best());
+    return active;
+}
+
+void vm_exp(long n, const double *a, double *y) {
+    table()->exp(n, a, y);
+}
+
+void vm_log(long n, const double *a, double *y) {
+    table()->log(n, a, y);
+}
+
+void vm_log10(long n, const double *a, double *y) {
+    table()->log10(n, a, y);
+}
+
+void vm_erf(long n, const double *a, double *y) {
+    table()->erf(n, a, y);
+}
+
+void vm_sin(long n, const double *a, double *y) {
+    table()->sin(n, a, y);
+}
+
+void vm_cos(long n, const double *a, double *y) {
+    table()->cos(n, a, y);
+}
+
+void vm_tanh(long n, const double *a, double *y) {
+    table()->tanh(n, a, y);
+}
+
+void vm_invsqrt(long n, const double *a, double *y) {
+    table()->invsqrt(n, a, y);
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Open vector math kernels for double precision arrays, for comparing
+ * against VML and SVML on identical inputs without depending on MKL or on
+ * the Intel compiler. The functions take the VML argument order,
+ * e.g. vm_exp(n, a, y) is the counterpart of vdExp(n, a, y), and run on
+ * the calling thread only. Like VML they may be called in place, a == y.
+ *
+ * The kernels are compiled once per entry of isa.h and the widest one the
+ * CPU supports is picked on the first call; vm_set_isa() forces another.
+ * Lanes the vector code does not cover (NaN, infinities, zero and negative
+ * arguments of the logarithms, |x| > 708 for exp, |x| > 2**20 * pi/2 for
+ * sin and cos) are recomputed with libm, so results agree with libm on
+ * special values.
+ *
+ * Maximum errors over the covered range, measured against long double:
+ *     exp, log, log10, erf, sin, cos      1 ulp
+ *     invsqrt                             1.5 ulp
+ *     tanh                                2.5 ulp
+ */
+
+#ifndef __VECMATH_H
+#define __VECMATH_H
+
+#include "isa.h"
+
+/* returns 0 on success, -1 if the CPU does not support isa */
+int vm_set_isa(enum isa isa);
+enum isa vm_get_isa(void);
+
+void vm_exp(long n, const double *a, double *y);
+void vm_log(long n, const double *a, double *y);
+void vm_log10(long n, const double *a, double *y);
+void vm_erf(long n, const double *a, double *y);
+void vm_sin(long n, const double *a, double *y);
+void vm_cos(long n, const double *a, double *y);
+void vm_tanh(long n, const double *a, double *y);
+void vm_invsqrt(long n, const double *a, double *y);
+
+#endif /* __VECMATH_H */
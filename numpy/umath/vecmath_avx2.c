@@ -0,0 +1,19 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/* vecmath kernels for AVX2 with FMA, four doubles per vector */
+
+#include <immintrin.h>
+
+#define VM_ISA avx2
+#define VM_WIDTH 4
+typedef __m256d vm_vd;
+typedef __m256i vm_vi;
+#define VM_FMA(a, b, c) _mm256_fmadd_pd(a, b, c)
+#define VM_SQRT(a) _mm256_sqrt_pd(a)
+#define VM_ANY(m) _mm256_movemask_pd((__m256d) (m))
+
+#include "vecmath_kernels.h"
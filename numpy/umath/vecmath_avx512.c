@@ -0,0 +1,19 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/* vecmath kernels for AVX-512F, eight doubles per vector */
+
+#include <immintrin.h>
+
+#define VM_ISA avx512
+#define VM_WIDTH 8
+typedef __m512d vm_vd;
+typedef __m512i vm_vi;
+#define VM_FMA(a, b, c) _mm512_fmadd_pd(a, b, c)
+#define VM_SQRT(a) _mm512_sqrt_pd(a)
+#define VM_ANY(m) _mm512_test_epi64_mask(m, m)
+
+#include "vecmath_kernels.h"
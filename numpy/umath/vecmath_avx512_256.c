@@ -0,0 +1,20 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/* vecmath kernels for AVX-512 restricted to 256-bit vectors, four doubles
+ * per vector, on the AVX-512VL encodings of the AVX2 code */
+
+#include <immintrin.h>
+
+#define VM_ISA avx512_256
+#define VM_WIDTH 4
+typedef __m256d vm_vd;
+typedef __m256i vm_vi;
+#define VM_FMA(a, b, c) _mm256_fmadd_pd(a, b, c)
+#define VM_SQRT(a) _mm256_sqrt_pd(a)
+#define VM_ANY(m) _mm256_movemask_pd((__m256d) (m))
+
+#include "vecmath_kernels.h"
@@ -0,0 +1,456 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Vector kernels behind vecmath.h, written once with GCC vector extensions
+ * and included by one translation unit per instruction set. The includer
+ * defines
+ *
+ *     VM_ISA          suffix of the exported functions, e.g. avx2
+ *     VM_WIDTH        doubles per vector
+ *     vm_vd, vm_vi    vector of VM_WIDTH doubles and of 64-bit integers
+ *     VM_FMA(a, b, c) a * b + c, fused where the ISA has it
+ *     VM_SQRT(a)      correctly rounded square root
+ *     VM_ANY(m)       nonzero if any lane of the comparison mask m is set
+ *
+ * The translation units are built with -ffp-contract=off, so that the
+ * compensated steps of the argument reductions are not contracted into
+ * FMAs; only the polynomials go through VM_FMA.
+ *
+ * The algorithms and constants follow fdlibm: Cody-Waite reduction for exp
+ * and for sin and cos, the Lg polynomial of log, the rational
+ * approximations of erf in four intervals and the sin and cos kernels on
+ * [-pi/4, pi/4] with a tail for the reduced argument.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#define VM_CAT2(a, b) a##_##b
+#define VM_CAT(a, b) VM_CAT2(a, b)
+#define VM_NAME(f) VM_CAT(vm_##f, VM_ISA)
+
+typedef unsigned long long vm_vu
+    __attribute__((vector_size(VM_WIDTH * sizeof(double))));
+
+#define VM_SIGN 0x8000000000000000LL
+#define VM_ABS 0x7fffffffffffffffLL
+/* 1.5 * 2**52: adding it rounds to an integer that ends up in the low
+ * bits of the mantissa */
+#define VM_SHIFT 0x1.8p52
+#define VM_SHIFT_BITS 0x4338000000000000LL
+
+static inline vm_vd vm_set(double c) {
+    vm_vd zero = {0};
+    return zero + c;
+}
+
+/* c[0] + x * (c[1] + ... + x * c[n - 1]) */
+static inline vm_vd vm_horner(vm_vd x, const double *c, int n) {
+    vm_vd p = vm_set(c[n - 1]);
+    int i;
+    for (i = n - 2; i >= 0; i--)
+        p = VM_FMA(p, x, vm_set(c[i]));
+    return p;
+}
+
+static inline vm_vd vm_select(vm_vi m, vm_vd a, vm_vd b) {
+    return (vm_vd) ((m & (vm_vi) a) | (~m & (vm_vi) b));
+}
+
+static inline vm_vd vm_abs(vm_vd x) {
+    return (vm_vd) ((vm_vi) x & VM_ABS);
+}
+
+static inline vm_vd vm_from_int(vm_vi k) {
+    return (vm_vd) (k + VM_SHIFT_BITS) - VM_SHIFT;
+}
+
+/* 2**k for -1022 <= k <= 1023 */
+static inline vm_vd vm_pow2(vm_vi k) {
+    return (vm_vd) ((k + 1023) << 52);
+}
+
+/* x with the low 32 bits of the mantissa cleared */
+static inline vm_vd vm_trunc32(vm_vd x) {
+    return (vm_vd) ((vm_vi) x & (long long) 0xffffffff00000000ULL);
+}
+
+/*
+ * exp
+ */
+
+static const double exp_log2e = 1.44269504088896338700e+00,
+                    exp_ln2_hi = 6.93147180369123816490e-01,
+                    exp_ln2_lo = 1.90821492927058770002e-10;
+
+/* x = k * ln2 + r with |r| <= ln2 / 2 */
+static inline vm_vd exp_reduce(vm_vd x, vm_vi *k) {
+    vm_vd t = x * exp_log2e + VM_SHIFT;
+    vm_vd fk = t - VM_SHIFT;
+    *k = (vm_vi) t - VM_SHIFT_BITS;
+    return (x - fk * exp_ln2_hi) - fk * exp_ln2_lo;
+}
+
+/* 1/2!, ..., 1/13!: Taylor series of exp(r) - 1 - r, divided by r**2 */
+static const double exp_c[] = {
+    5.00000000000000000000e-01, 1.66666666666666657415e-01,
+    4.16666666666666643537e-02, 8.33333333333333321769e-03,
+    1.38888888888888894189e-03, 1.98412698412698412526e-04,
+    2.48015873015873015658e-05, 2.75573192239858925110e-06,
+    2.75573192239858906526e-07, 2.50521083854417187751e-08,
+    2.08767569878680989792e-09, 1.60590438368216145994e-10};
+
+static inline vm_vd exp_poly(vm_vd r) {
+    return vm_horner(r, exp_c, 12) * r * r;
+}
+
+static inline vm_vd kernel_exp(vm_vd x, vm_vi *special) {
+    vm_vi k;
+    vm_vd r;
+
+    *special = (vm_vi) (vm_abs(x) > 708.0) | (vm_vi) (x != x);
+    r = exp_reduce(x, &k);
+    return (1.0 + (r + exp_poly(r))) * vm_pow2(k);
+}
+
+/* expm1 for |x| <= 44. The rounding error c of the reduced argument is
+ * carried along, as exp(r + c) - 1 ~= (exp(r) - 1) + c * (1 + r). */
+static inline vm_vd kernel_expm1(vm_vd x) {
+    vm_vd t = x * exp_log2e + VM_SHIFT;
+    vm_vd fk = t - VM_SHIFT, hi, lo, r, c, p, two_k;
+    vm_vi k = (vm_vi) t - VM_SHIFT_BITS;
+
+    hi = x - fk * exp_ln2_hi;
+    lo = fk * exp_ln2_lo;
+    r = hi - lo;
+    c = (hi - r) - lo;
+    p = r + (exp_poly(r) + (c + c * r));
+    two_k = vm_pow2(k);
+    return two_k * p + (two_k - 1.0);
+}
+
+/*
+ * log, log10
+ */
+
+/* Lg1, Lg3, Lg5, Lg7 and Lg2, Lg4, Lg6 of fdlibm, for the odd and even
+ * powers of s**2 */
+static const double lg_odd[] = {6.666666666666735130e-01, 2.857142874366239149e-01,
+                                1.818357216161805012e-01, 1.479819860511658591e-01};
+static const double lg_even[] = {3.999999999940941908e-01, 2.222219843214978396e-01,
+                                 1.531383769920937332e-01};
+
+static const double log_ln2_hi = 6.93147180369123816490e-01,
+                    log_ln2_lo = 1.90821492927058770002e-10;
+
+/*
+ * x = 2**k * (1 + f) with sqrt(2)/2 <= 1 + f < sqrt(2), and
+ * log(1 + f) = f - hfsq + r for hfsq = f * f / 2. Only normal positive
+ * finite x are covered.
+ */
+static inline void log_reduce(vm_vd x, vm_vi *special, vm_vd *k, vm_vd *f,
+                              vm_vd *hfsq, vm_vd *r) {
+    vm_vi ix = (vm_vi) x, big, ik;
+    vm_vd m, s, z, w, t1, t2;
+
+    *special = ~((vm_vi) (x >= 2.2250738585072014e-308) &
+                 (vm_vi) (x <= 1.7976931348623157e+308));
+    ik = (vm_vi) ((vm_vu) ix >> 52) - 1023;
+    m = (vm_vd) ((ix & 0x000fffffffffffffLL) | 0x3ff0000000000000LL);
+    big = (vm_vi) (m > 1.41421356237309504880);
+    m = vm_select(big, m * 0.5, m);
+    *k = vm_from_int(ik - big);
+
+    *f = m - 1.0;
+    *hfsq = 0.5 * *f * *f;
+    s = *f / (2.0 + *f);
+    z = s * s;
+    w = z * z;
+    t1 = w * vm_horner(w, lg_even, 3);
+    t2 = z * vm_horner(w, lg_odd, 4);
+    *r = s * (*hfsq + (t2 + t1));
+}
+
+static inline vm_vd kernel_log(vm_vd x, vm_vi *special) {
+    vm_vd k, f, hfsq, r;
+
+    log_reduce(x, special, &k, &f, &hfsq, &r);
+    return k * log_ln2_hi - ((hfsq - (r + k * log_ln2_lo)) - f);
+}
+
+static const double ivln10_hi = 4.34294481878168880939e-01,
+                    ivln10_lo = 2.50829467116452752298e-11,
+                    log10_2_hi = 3.01029995663611771306e-01,
+                    log10_2_lo = 3.69423907715893078616e-13;
+
+static inline vm_vd kernel_log10(vm_vd x, vm_vi *special) {
+    vm_vd k, f, hfsq, r, hi, lo, val_hi, val_lo, y2, w;
+
+    log_reduce(x, special, &k, &f, &hfsq, &r);
+    /* f - hfsq in two parts, so that the scaling by 1/ln(10) is exact
+     * for the leading one */
+    hi = vm_trunc32(f - hfsq);
+    lo = ((f - hi) - hfsq) + r;
+    val_hi = hi * ivln10_hi;
+    y2 = k * log10_2_hi;
+    val_lo = k * log10_2_lo + ((lo + hi) * ivln10_lo + lo * ivln10_hi);
+    w = y2 + val_hi;
+    val_lo = val_lo + ((y2 - w) + val_hi);
+    return val_lo + w;
+}
+
+/*
+ * erf
+ */
+
+static const double erx = 8.45062911510467529297e-01;
+/* erf(x) = x + x * pp(x**2) / qq(x**2) on [0, 0.84375) */
+static const double erf_pp[] = {
+    1.28379167095512558561e-01, -3.25042107247001499370e-01,
+    -2.84817495755985104766e-02, -5.77027029648944159157e-03,
+    -2.37630166566501626084e-05};
+static const double erf_qq[] = {
+    1.0, 3.97917223959155352819e-01, 6.50222499887672944485e-02,
+    5.08130628187576562776e-03, 1.32494738004321644526e-04,
+    -3.96022827877536812320e-06};
+/* erf(x) = erx + pa(x - 1) / qa(x - 1) on [0.84375, 1.25) */
+static const double erf_pa[] = {
+    -2.36211856075265944077e-03, 4.14856118683748331666e-01,
+    -3.72207876035701323847e-01, 3.18346619901161753674e-01,
+    -1.10894694282396677476e-01, 3.54783043256182359371e-02,
+    -2.16637559486879084300e-03};
+static const double erf_qa[] = {
+    1.0, 1.06420880400844228286e-01, 5.40397917702171048937e-01,
+    7.18286544141962662868e-02, 1.26171219808761642112e-01,
+    1.36370839120290507362e-02, 1.19844998467991074170e-02};
+/* erfc(x) = exp(-x**2 - 0.5625 + ra(1/x**2) / sa(1/x**2)) / x on
+ * [1.25, 1/0.35) and with rb, sb on [1/0.35, 6) */
+static const double erf_ra[] = {
+    -9.86494403484714822705e-03, -6.93858572707181764372e-01,
+    -1.05586262253232909814e+01, -6.23753324503260060396e+01,
+    -1.62396669462573470355e+02, -1.84605092906711035994e+02,
+    -8.12874355063065934246e+01, -9.81432934416914548592e+00};
+static const double erf_sa[] = {
+    1.0, 1.96512716674392571292e+01, 1.37657754143519042600e+02,
+    4.34565877475229228821e+02, 6.45387271733267880336e+02,
+    4.29008140027567833386e+02, 1.08635005541779435134e+02,
+    6.57024977031928170135e+00, -6.04244152148580987438e-02};
+static const double erf_rb[] = {
+    -9.86494292470009928597e-03, -7.99283237680523006574e-01,
+    -1.77579549177547519889e+01, -1.60636384855821916062e+02,
+    -6.37566443368389627722e+02, -1.02509513161107724954e+03,
+    -4.83519191608651397019e+02};
+static const double erf_sb[] = {
+    1.0, 3.03380607434824582924e+01, 3.25792512996573918826e+02,
+    1.53672958608443695994e+03, 3.19985821950859553908e+03,
+    2.55305040643316442583e+03, 4.74528541206955367215e+02,
+    -2.24409524465858183362e+01};
+
+/* The four intervals use different approximations. Each one is only
+ * evaluated when at least one lane falls into it. */
+static inline vm_vd kernel_erf(vm_vd x, vm_vi *special) {
+    vm_vd a = vm_abs(x), res = a, z, s, p, q, e;
+    vm_vi in, lo, unused;
+
+    *special = (vm_vi) (x != x);
+
+    in = (vm_vi) (a < 0.84375);
+    if (VM_ANY(in)) {
+        z = a * a;
+        p = vm_horner(z, erf_pp, 5) / vm_horner(z, erf_qq, 6);
+        res = vm_select(in, a + a * p, res);
+    }
+
+    in = (vm_vi) (a >= 0.84375) & (vm_vi) (a < 1.25);
+    if (VM_ANY(in)) {
+        s = a - 1.0;
+        p = vm_horner(s, erf_pa, 7) / vm_horner(s, erf_qa, 7);
+        res = vm_select(in, erx + p, res);
+    }
+
+    in = (vm_vi) (a >= 1.25) & (vm_vi) (a < 6.0);
+    if (VM_ANY(in)) {
+        s = 1.0 / (a * a);
+        /* fdlibm splits at the high word of 1/0.35 */
+        lo = (vm_vi) ((vm_vi) a < 0x4006DB6D00000000LL);
+        p = q = s;
+        if (VM_ANY(in & lo))
+            p = vm_horner(s, erf_ra, 8) / vm_horner(s, erf_sa, 9);
+        if (VM_ANY(in & ~lo))
+            q = vm_horner(s, erf_rb, 7) / vm_horner(s, erf_sb, 8);
+        p = vm_select(lo, p, q);
+        /* exp(-x**2) as exp(-z**2) * exp((z - x) * (z + x)), where z**2
+         * is exact */
+        z = vm_trunc32(a);
+        e = kernel_exp(-z * z - 0.5625, &unused) *
+            kernel_exp((z - a) * (z + a) + p, &unused);
+        res = vm_select(in, 1.0 - e / a, res);
+    }
+
+    /* 1 from 6 on, including infinity */
+    res = vm_select((vm_vi) (a >= 6.0), vm_set(1.0), res);
+
+    return (vm_vd) ((vm_vi) res | ((vm_vi) x & VM_SIGN));
+}
+
+/*
+ * sin, cos
+ */
+
+static const double invpio2 = 6.36619772367581382433e-01,
+                    pio2_1 = 1.57079632673412561417e+00,
+                    pio2_2 = 6.07710050630396597660e-11,
+                    pio2_2t = 2.02226624879595063154e-21;
+/* 2**20 * pi/2, below which n * pio2_1 and n * pio2_2 are exact */
+static const double trig_max = 1.64713350540630e+06;
+
+/* x = n * pi/2 + y0 + y1 with |y0 + y1| <= pi/4, good to 118 bits */
+static inline void trig_reduce(vm_vd x, vm_vi *special, vm_vi *n, vm_vd *y0,
+                               vm_vd *y1) {
+    vm_vd t = x * invpio2 + VM_SHIFT;
+    vm_vd fn = t - VM_SHIFT, r, w;
+
+    *special = ~(vm_vi) (vm_abs(x) <= trig_max);
+    *n = (vm_vi) t - VM_SHIFT_BITS;
+    r = x - fn * pio2_1;
+    t = r;
+    w = fn * pio2_2;
+    r = t - w;
+    w = fn * pio2_2t - ((t - r) - w);
+    *y0 = r - w;
+    *y1 = (r - *y0) - w;
+}
+
+/* S2..S6 of the fdlibm sin kernel; S1 is applied separately */
+static const double sin_s1 = -1.66666666666666324348e-01;
+static const double sin_s[] = {
+    8.33333333332248946124e-03, -1.98412698298579493134e-04,
+    2.75573137070700676789e-06, -2.50507602534068634195e-08,
+    1.58969099521155010221e-10};
+
+static inline vm_vd trig_sin(vm_vd x, vm_vd y) {
+    vm_vd z = x * x, v = z * x, r = vm_horner(z, sin_s, 5);
+
+    return x - ((z * (0.5 * y - v * r) - y) - v * sin_s1);
+}
+
+/* C1..C3 and C4..C6 of the fdlibm cos kernel */
+static const double cos_lo[] = {4.16666666666666019037e-02,
+                                -1.38888888888741095749e-03,
+                                2.48015872894767294178e-05};
+static const double cos_hi[] = {-2.75573143513906633035e-07,
+                                2.08757232129817482790e-09,
+                                -1.13596475577881948265e-11};
+
+static inline vm_vd trig_cos(vm_vd x, vm_vd y) {
+    vm_vd z = x * x, w = z * z, r, hz;
+
+    r = z * vm_horner(z, cos_lo, 3) + w * w * vm_horner(z, cos_hi, 3);
+    hz = 0.5 * z;
+    w = 1.0 - hz;
+    return w + (((1.0 - w) - hz) + (z * r - x * y));
+}
+
+/* pick sin or cos of the reduced argument by quadrant: odd quadrants swap
+ * them, quadrants 2 and 3 (after shifting by 1 for cos) negate */
+static inline vm_vd trig_quadrant(vm_vd y0, vm_vd y1, vm_vi q) {
+    vm_vi odd = -(q & 1);
+    vm_vd r = vm_select(odd, trig_cos(y0, y1), trig_sin(y0, y1));
+    return (vm_vd) ((vm_vi) r ^ ((q & 2) << 62));
+}
+
+static inline vm_vd kernel_sin(vm_vd x, vm_vi *special) {
+    vm_vi n;
+    vm_vd y0, y1;
+
+    trig_reduce(x, special, &n, &y0, &y1);
+    return trig_quadrant(y0, y1, n);
+}
+
+static inline vm_vd kernel_cos(vm_vd x, vm_vi *special) {
+    vm_vi n;
+    vm_vd y0, y1;
+
+    trig_reduce(x, special, &n, &y0, &y1);
+    return trig_quadrant(y0, y1, n + 1);
+}
+
+/*
+ * tanh
+ */
+
+/* fdlibm: for |x| >= 1, 1 - 2 / (expm1(2|x|) + 2), otherwise
+ * -t / (t + 2) with t = expm1(-2|x|), and 1 from |x| >= 22 on */
+static inline vm_vd kernel_tanh(vm_vd x, vm_vi *special) {
+    vm_vd a = vm_abs(x), u, t, z;
+    vm_vi big = (vm_vi) (a >= 1.0);
+
+    *special = (vm_vi) (x != x);
+    u = vm_select((vm_vi) (a > 22.0), vm_set(22.0), a);
+    u = vm_select(big, 2.0 * u, -2.0 * u);
+    t = kernel_expm1(u);
+    z = vm_select(big, 1.0 - 2.0 / (t + 2.0), -t / (t + 2.0));
+    z = vm_select((vm_vi) (a >= 22.0), vm_set(1.0), z);
+    /* -t / (t + 2) is -0 for x = +0 */
+    return (vm_vd) ((vm_vi) vm_abs(z) | ((vm_vi) x & VM_SIGN));
+}
+
+/*
+ * invsqrt, exact up to the two roundings
+ */
+
+static inline vm_vd kernel_invsqrt(vm_vd x, vm_vi *special) {
+    vm_vi none = {0};
+
+    *special = none;
+    return 1.0 / VM_SQRT(x);
+}
+
+static inline double scalar_invsqrt(double x) {
+    return 1.0 / sqrt(x);
+}
+
+/*
+ * Array loops: whole vectors are loaded straight from the array, the tail
+ * goes through a buffer padded with ones, and lanes flagged special are
+ * recomputed with the scalar function.
+ */
+#define VM_DEFINE(f, scalar)                                                  \
+    void VM_NAME(f)(long n, const double *a, double *y) {                    \
+        double buf[VM_WIDTH];                                                \
+        vm_vd v, r;                                                          \
+        vm_vi special;                                                       \
+        long i = 0, k;                                                       \
+                                                                             \
+        for (; i + VM_WIDTH <= n; i += VM_WIDTH) {                           \
+            memcpy(&v, a + i, sizeof(v));                                    \
+            r = kernel_##f(v, &special);                                     \
+            memcpy(y + i, &r, sizeof(r));                                    \
+            if (VM_ANY(special))                                             \
+                for (k = 0; k < VM_WIDTH; k++)                               \
+                    if (special[k])                                          \
+                        y[i + k] = scalar(v[k]);                             \
+        }                                                                    \
+        if (i == n)                                                          \
+            return;                                                          \
+        for (k = 0; k < VM_WIDTH; k++)                                       \
+            buf[k] = i + k < n ? a[i + k] : 1.0;                             \
+        memcpy(&v, buf, sizeof(v));                                          \
+        r = kernel_##f(v, &special);                                         \
+        memcpy(buf, &r, sizeof(r));                                          \
+        for (k = 0; i + k < n; k++)                                          \
+            y[i + k] = special[k] ? scalar(v[k]) : buf[k];                   \
+    }
+
+VM_DEFINE(exp, exp)
+VM_DEFINE(log, log)
+VM_DEFINE(log10, log10)
+VM_DEFINE(erf, erf)
+VM_DEFINE(sin, sin)
+VM_DEFINE(cos, cos)
+VM_DEFINE(tanh, tanh)
+VM_DEFINE(invsqrt, scalar_invsqrt)
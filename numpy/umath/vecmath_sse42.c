@@ -0,0 +1,19 @@
+/*
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/* vecmath kernels for SSE4.2, two doubles per vector */
+
+#include <nmmintrin.h>
+
+#define VM_ISA sse42
+#define VM_WIDTH 2
+typedef __m128d vm_vd;
+typedef __m128i vm_vi;
+#define VM_FMA(a, b, c) ((a) * (b) + (c))
+#define VM_SQRT(a) _mm_sqrt_pd(a)
+#define VM_ANY(m) _mm_movemask_pd((__m128d) (m))
+
+#include "vecmath_kernels.h"